@@ -0,0 +1,32 @@
+/* Arrays: a sieve, a shell sort and arrays passed to functions. */
+scale = 0
+n = 100000
+for (i = 2; i <= n; i++) p[i] = 1
+for (i = 2; i * i <= n; i++) if (p[i]) for (j = i * i; j <= n; j += i) p[j] = 0
+c = 0
+for (i = 2; i <= n; i++) c += p[i]
+c
+
+define sort (*a[], n) {
+  auto g, i, j, t
+  for (g = n / 2; g > 0; g /= 2) {
+    for (i = g; i < n; i++) {
+      t = a[i]
+      for (j = i; j >= g && a[j-g] > t; j -= g) a[j] = a[j-g]
+      a[j] = t
+    }
+  }
+  return (0)
+}
+define sum (a[], n) {
+  auto i, s
+  for (i = 0; i < n; i++) s += a[i]
+  return (s)
+}
+x = 12345
+for (i = 0; i < 5000; i++) { x = (x * 1103515245 + 12345) % 2^31; v[i] = x }
+z = sort (v[], 5000)
+v[0]; v[4999]
+for (i = 0; i < 20; i++) s = sum (v[], 5000)
+s
+quit
@@ -0,0 +1,5 @@
+/* The math library at scale 2000. */
+scale = 2000
+for (i = 1; i <= 5; i++) x = s(i) + c(i) + a(1/i) + l(i) + e(1/i) + sqrt(i)
+x
+quit
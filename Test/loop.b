@@ -0,0 +1,12 @@
+/* Integer loops: a counted sum and a trial division prime count. */
+scale = 0
+s = 0
+for (i = 0; i < 300000; i++) s += i % 7
+s
+c = 0
+for (n = 2; n < 20000; n++) {
+  for (d = 2; d * d <= n; d++) if (n % d == 0) break
+  if (d * d > n) c += 1
+}
+c
+quit
@@ -0,0 +1,10 @@
+/* Printing a big number in several output bases. */
+x = 7^20000
+obase = 2; x
+obase = 8; x
+obase = 16; x
+obase = 10; x
+obase = 100; x
+obase = 3; x
+obase = 1000; x
+quit
@@ -0,0 +1,431 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* api.c - bc as a library, for the interface in bcapi.h. */
+
+#include "bcdefs.h"
+#include "proto.h"
+#include "bcapi.h"
+
+/* This file takes the place of main.c in libbcapi.a.  The program
+   text of each bc_interp_eval is given to the scanner as a string
+   buffer and parsed and run just as a file would be.  The output and
+   messages go to memory streams instead of stdout and stderr.
+
+   Every call into the interpreter sets exit_jump, so that bc_exit
+   (for quit, halt, or a fatal error) comes back here instead of
+   ending the program.  The interpreter may be in the middle of
+   anything when that happens, so after it only destroy is allowed. */
+
+struct bc_interp {
+      FILE   *out;		/* The output stream and its text. */
+      char   *out_text;
+      size_t  out_len;
+      FILE   *err;		/* The message stream and its text. */
+      char   *err_text;
+      size_t  err_len;
+      char    ended;		/* bc_exit was called. */
+    };
+
+/* The one interpreter. */
+static bc_interp *the_interp = NULL;
+
+/* From scan.c. */
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+YY_BUFFER_STATE yy_scan_bytes (const char *bytes, int len);
+void yy_delete_buffer (YY_BUFFER_STATE b);
+
+/* The arguments of the call being made by api_call. */
+static const char    *call_name;
+static unsigned long  call_index;
+static bc_num        *call_value;
+static int            call_result;
+
+
+/* The scanner gets no more input after the string. */
+
+int
+open_new_file (void)
+{
+  line_no = 1;
+  return FALSE;
+}
+
+void
+new_yy_file (FILE *file)
+{
+  yyin = file;
+}
+
+/* No signal handler is set by an embedded interpreter. */
+
+void
+use_quit (int sig)
+{
+}
+
+
+/* Start new output and message streams for INTERP.  Returns FALSE if
+   they could not be opened. */
+
+static int
+open_streams (bc_interp *interp)
+{
+  if (interp->out != NULL)
+    fclose (interp->out);
+  if (interp->err != NULL)
+    fclose (interp->err);
+  free (interp->out_text);
+  free (interp->err_text);
+  interp->out_text = interp->err_text = NULL;
+
+  interp->out = open_memstream (&interp->out_text, &interp->out_len);
+  interp->err = open_memstream (&interp->err_text, &interp->err_len);
+  out_file = interp->out;
+  err_file = interp->err;
+  return interp->out != NULL && interp->err != NULL;
+}
+
+
+/* Call FUNC with exit_jump set.  Returns BC_EXIT if it called bc_exit,
+   otherwise call_result. */
+
+static int
+api_call (bc_interp *interp, void (*func) (void))
+{
+  jmp_buf here;
+
+  if (interp->ended)
+    return BC_EXIT;
+  call_result = BC_OK;
+  exit_jump = &here;
+  if (setjmp (here) == 0)
+    func ();
+  else
+    {
+      interp->ended = TRUE;
+      call_result = BC_EXIT;
+    }
+  exit_jump = NULL;
+  fflush (interp->out);
+  fflush (interp->err);
+  return call_result;
+}
+
+
+/* Set up the machine, as main does. */
+
+static void
+do_create (void)
+{
+  interactive = FALSE;
+  line_size = 0;
+  init_storage ();
+  init_load ();
+  init_tree ();
+  init_gen ();
+  is_std_in = TRUE;
+  line_no = 1;
+  if (use_math)
+    load_mathlib ();
+}
+
+bc_interp *
+bc_interp_create (int mathlib)
+{
+  bc_interp *interp;
+
+  if (the_interp != NULL)
+    return NULL;
+  interp = calloc (1, sizeof (bc_interp));
+  if (interp == NULL)
+    return NULL;
+  if (!open_streams (interp))
+    {
+      bc_interp_destroy (interp);
+      return NULL;
+    }
+
+  the_interp = interp;
+  use_math = (mathlib != 0);
+  if (api_call (interp, do_create) != BC_OK)
+    {
+      /* The storage may be half made, so it is not freed. */
+      the_interp = NULL;
+      interp->ended = TRUE;
+      bc_interp_destroy (interp);
+      return NULL;
+    }
+  return interp;
+}
+
+
+void
+bc_interp_destroy (bc_interp *interp)
+{
+  if (interp == NULL)
+    return;
+  if (interp == the_interp)
+    {
+      free_storage ();
+      free_tree ();
+      the_interp = NULL;
+    }
+  if (interp->out != NULL)
+    fclose (interp->out);
+  if (interp->err != NULL)
+    fclose (interp->err);
+  free (interp->out_text);
+  free (interp->err_text);
+  free (interp);
+  out_file = stdout;
+  err_file = stderr;
+}
+
+
+/* Parse and run call_name, which is the program text. */
+
+static YY_BUFFER_STATE eval_buffer = NULL;
+
+static void
+do_eval (void)
+{
+  int len, errors;
+  char *text;
+
+  errors = error_count;
+  len = strlen (call_name);
+  text = bc_malloc (len + 2);
+  memcpy (text, call_name, len);
+  if (len == 0 || text[len-1] != '\n')
+    text[len++] = '\n';
+  text[len] = '\0';
+
+  init_gen ();
+  line_no = 1;
+  out_col = 0;
+  eval_buffer = yy_scan_bytes (text, len);
+  free (text);
+  limit_start ();
+  yyparse ();
+  limit_stop ();
+  yy_delete_buffer (eval_buffer);
+  eval_buffer = NULL;
+
+  if (error_count != errors)
+    call_result = BC_ERROR;
+}
+
+int
+bc_interp_eval (bc_interp *interp, const char *text)
+{
+  int result;
+
+  if (interp->ended)
+    return BC_EXIT;
+  if (!open_streams (interp))
+    return BC_ERROR;
+  call_name = text;
+  result = api_call (interp, do_eval);
+  if (result == BC_EXIT && eval_buffer != NULL)
+    {
+      yy_delete_buffer (eval_buffer);
+      eval_buffer = NULL;
+    }
+  return result;
+}
+
+
+void
+bc_interp_set_limits (bc_interp *interp, unsigned long instructions,
+		      long timeout_ms, size_t max_memory)
+{
+  /* The limits are bc's own, as there is one interpreter. */
+  max_instructions = instructions;
+  time_limit = (timeout_ms > 0 ? timeout_ms : 0);
+  bc_mem_limit = max_memory;
+}
+
+
+const char *
+bc_interp_output (bc_interp *interp, size_t *len)
+{
+  fflush (interp->out);
+  if (len != NULL)
+    *len = interp->out_len;
+  return interp->out_text;
+}
+
+const char *
+bc_interp_errors (bc_interp *interp, size_t *len)
+{
+  fflush (interp->err);
+  if (len != NULL)
+    *len = interp->err_len;
+  return interp->err_text;
+}
+
+
+/* The words of scan.l that are not variables.  A program could never
+   use a variable or array with one of these names. */
+
+static const char *keywords[] = {
+  "auto", "break", "continue", "define", "else", "for", "halt",
+#if defined(READLINE) || defined(LIBEDIT)
+  "history",
+#endif
+  "if", "length", "limits", "print", "quit", "random", "read", "return",
+  "sqrt", "void", "warranty", "while", NULL
+};
+
+/* The number of the variable or array (when ARRAY) call_name, or -1
+   if it is not a name bc would accept.  The special variables are
+   numbered as in storage.c; they are not array names. */
+
+static int
+name_number (int array)
+{
+  const char *ch;
+  int ix;
+
+  if (!islower ((int) call_name[0]))
+    return -1;
+  for (ch = call_name+1; *ch != '\0'; ch++)
+    if (!islower ((int) *ch) && !isdigit ((int) *ch) && *ch != '_')
+      return -1;
+  for (ix = 0; keywords[ix] != NULL; ix++)
+    if (strcmp (call_name, keywords[ix]) == 0)
+      return -1;
+
+  if (strcmp (call_name, "ibase") == 0) return (array ? -1 : 0);
+  if (strcmp (call_name, "obase") == 0) return (array ? -1 : 1);
+  if (strcmp (call_name, "scale") == 0) return (array ? -1 : 2);
+  if (strcmp (call_name, "last") == 0)  return (array ? -1 : 4);
+  if (array)
+    return -lookup (strcopyof (call_name), ARRAY);
+  return lookup (strcopyof (call_name), SIMPLE);
+}
+
+/* The variables are moved through the execution stack, so that the
+   special ones are checked just as for an assignment. */
+
+static void
+do_get_var (void)
+{
+  int var_name = name_number (FALSE);
+
+  if (var_name < 0)
+    {
+      call_result = BC_BADNAME;
+      return;
+    }
+  load_var (var_name);
+  *call_value = bc_copy_num (ex_stack->s_num);
+  pop ();
+}
+
+static void
+do_set_var (void)
+{
+  int var_name = name_number (FALSE);
+
+  if (var_name < 0)
+    {
+      call_result = BC_BADNAME;
+      return;
+    }
+  push_copy (*call_value);
+  store_var (var_name);
+  pop ();
+}
+
+static void
+do_get_array (void)
+{
+  int var_name = name_number (TRUE);
+
+  if (var_name < 0)
+    call_result = BC_BADNAME;
+  else if (call_index > BC_DIM_MAX)
+    call_result = BC_BADINDEX;
+  else
+    *call_value = bc_copy_num (*get_array_num (var_name, call_index));
+}
+
+static void
+do_set_array (void)
+{
+  int var_name = name_number (TRUE);
+  bc_num *num_ptr;
+
+  if (var_name < 0)
+    call_result = BC_BADNAME;
+  else if (call_index > BC_DIM_MAX)
+    call_result = BC_BADINDEX;
+  else
+    {
+      num_ptr = get_array_num (var_name, call_index);
+      bc_free_num (num_ptr);
+      *num_ptr = bc_copy_num (*call_value);
+    }
+}
+
+
+int
+bc_interp_get_var (bc_interp *interp, const char *name, bc_num *value)
+{
+  call_name = name;
+  call_value = value;
+  return api_call (interp, do_get_var);
+}
+
+int
+bc_interp_set_var (bc_interp *interp, const char *name, bc_num value)
+{
+  call_name = name;
+  call_value = &value;
+  return api_call (interp, do_set_var);
+}
+
+int
+bc_interp_get_array (bc_interp *interp, const char *name,
+		     unsigned long index, bc_num *value)
+{
+  call_name = name;
+  call_index = index;
+  call_value = value;
+  return api_call (interp, do_get_array);
+}
+
+int
+bc_interp_set_array (bc_interp *interp, const char *name,
+		     unsigned long index, bc_num value)
+{
+  call_name = name;
+  call_index = index;
+  call_value = &value;
+  return api_call (interp, do_set_array);
+}
@@ -0,0 +1,181 @@
+/* apitest.c: Check the interface of bcapi.h. */
+/*
+    Copyright (C) 2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, write to:
+
+      The Free Software Foundation, Inc.
+      51 Franklin Street, Fifth Floor
+      Boston, MA 02110-1301  USA
+
+
+    An interpreter is created, used for programs, variables, arrays
+    and limits, ended with quit, destroyed, and created again.  Each
+    check that fails is printed.  The exit status is 1 if any did.
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <config.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#include <limits.h>
+#include "bcapi.h"
+
+static int failures = 0;
+
+#define CHECK(cond) check ((cond), #cond, __LINE__)
+
+static void
+check (int ok, const char *what, int line)
+{
+  if (!ok)
+    {
+      printf ("apitest.c:%d: failed: %s\n", line, what);
+      failures++;
+    }
+}
+
+/* Is the output of the last eval TEXT? */
+
+static int
+output_is (bc_interp *interp, const char *text)
+{
+  const char *out = bc_interp_output (interp, NULL);
+
+  return out != NULL && strcmp (out, text) == 0;
+}
+
+/* Do the last eval's messages contain TEXT? */
+
+static int
+errors_have (bc_interp *interp, const char *text)
+{
+  const char *err = bc_interp_errors (interp, NULL);
+
+  return err != NULL && strstr (err, text) != NULL;
+}
+
+/* Is NUM, which is freed, TEXT? */
+
+static int
+value_is (bc_num num, const char *text)
+{
+  char *str;
+  int same;
+
+  if (num == NULL)
+    return FALSE;
+  str = bc_num2str (num);
+  same = (strcmp (str, text) == 0);
+  free (str);
+  bc_free_num (&num);
+  return same;
+}
+
+int
+main (void)
+{
+  bc_interp *interp;
+  bc_num num = NULL, got;
+
+  /* Create and eval. */
+  interp = bc_interp_create (1);
+  CHECK (interp != NULL);
+  if (interp == NULL)
+    return 1;
+  CHECK (bc_interp_create (0) == NULL);
+  CHECK (bc_interp_eval (interp, "x = 6 * 7; x") == BC_OK);
+  CHECK (output_is (interp, "42\n"));
+  CHECK (bc_interp_eval (interp, "scale = 5; e(0)") == BC_OK);
+  CHECK (output_is (interp, "1.00000\n"));
+  CHECK (bc_interp_eval (interp, "define f(n) { return n + 1; }") == BC_OK);
+  CHECK (bc_interp_eval (interp, "f(x)") == BC_OK);
+  CHECK (output_is (interp, "43\n"));
+
+  /* An error leaves the interpreter usable. */
+  CHECK (bc_interp_eval (interp, "1 +") == BC_ERROR);
+  CHECK (errors_have (interp, "syntax error"));
+  CHECK (bc_interp_eval (interp, "x") == BC_OK);
+  CHECK (output_is (interp, "42\n"));
+
+  /* Variables. */
+  got = NULL;
+  CHECK (bc_interp_get_var (interp, "x", &got) == BC_OK);
+  CHECK (value_is (got, "42"));
+  got = NULL;
+  CHECK (bc_interp_get_var (interp, "scale", &got) == BC_OK);
+  CHECK (value_is (got, "5"));
+  bc_str2num (&num, "2.5", 1);
+  CHECK (bc_interp_set_var (interp, "y", num) == BC_OK);
+  CHECK (bc_interp_eval (interp, "y * 2") == BC_OK);
+  CHECK (output_is (interp, "5.0\n"));
+  CHECK (bc_interp_set_var (interp, "Y", num) == BC_BADNAME);
+  CHECK (bc_interp_set_var (interp, "2y", num) == BC_BADNAME);
+  CHECK (bc_interp_set_var (interp, "if", num) == BC_BADNAME);
+  CHECK (bc_interp_set_var (interp, "define", num) == BC_BADNAME);
+  CHECK (bc_interp_set_var (interp, "quit", num) == BC_BADNAME);
+
+  /* Arrays. */
+  CHECK (bc_interp_set_array (interp, "a", 3, num) == BC_OK);
+  CHECK (bc_interp_eval (interp, "a[3]; b[7] = 9") == BC_OK);
+  CHECK (output_is (interp, "2.5\n"));
+  got = NULL;
+  CHECK (bc_interp_get_array (interp, "b", 7, &got) == BC_OK);
+  CHECK (value_is (got, "9"));
+  got = NULL;
+  CHECK (bc_interp_get_array (interp, "b", ULONG_MAX, &got) == BC_BADINDEX);
+  CHECK (bc_interp_set_array (interp, "scale", 0, num) == BC_BADNAME);
+  CHECK (bc_interp_set_array (interp, "while", 0, num) == BC_BADNAME);
+
+  /* Limits stop a program, and the interpreter goes on. */
+  bc_interp_set_limits (interp, 10000, 0, 0);
+  CHECK (bc_interp_eval (interp, "while (1) {}") == BC_ERROR);
+  CHECK (errors_have (interp, "Instruction limit exceeded"));
+  bc_interp_set_limits (interp, 0, 100, 0);
+  CHECK (bc_interp_eval (interp, "while (1) {}") == BC_ERROR);
+  CHECK (errors_have (interp, "Time limit exceeded"));
+  bc_interp_set_limits (interp, 0, 0, 0);
+  CHECK (bc_interp_eval (interp, "x + 1") == BC_OK);
+  CHECK (output_is (interp, "43\n"));
+
+  /* quit ends the interpreter. */
+  CHECK (bc_interp_eval (interp, "quit") == BC_EXIT);
+  CHECK (bc_interp_eval (interp, "1") == BC_EXIT);
+  bc_interp_destroy (interp);
+
+  /* A new one starts empty. */
+  interp = bc_interp_create (0);
+  CHECK (interp != NULL);
+  if (interp == NULL)
+    return 1;
+  got = NULL;
+  CHECK (bc_interp_get_var (interp, "x", &got) == BC_OK);
+  CHECK (value_is (got, "0"));
+  CHECK (bc_interp_eval (interp, "scale") == BC_OK);
+  CHECK (output_is (interp, "0\n"));
+  CHECK (bc_interp_eval (interp, "f(1)") == BC_ERROR);
+  CHECK (bc_interp_eval (interp, "2 ^ 10") == BC_OK);
+  CHECK (output_is (interp, "1024\n"));
+  bc_interp_destroy (interp);
+
+  bc_free_num (&num);
+  if (failures != 0)
+    printf ("apitest: %d checks failed\n", failures);
+  return failures != 0;
+}
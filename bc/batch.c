@@ -0,0 +1,304 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* batch.c - framed requests and replies for --batch. */
+
+#include "bcdefs.h"
+#include <errno.h>
+#include "proto.h"
+
+/* In batch mode the standard input is a series of requests, each a
+   line with a decimal byte count followed by that many bytes of bc
+   program.  The program text is handed to the scanner as if it had
+   been read from the standard input, so the variables and functions
+   defined by one request are there for the next.
+
+   The end of a request is the end of the input for the parser, so a
+   function definition, string or comment left open is an error of
+   that request.  Once the parse ends, the request has been run and
+   batch_next starts the parser and scanner over for the next one.
+
+   Everything the request writes to the standard output and standard
+   error is kept in a temporary file.  The reply is written with a
+   single write: a line "ok N" or "error N", where N is the byte
+   count, followed by the N bytes of output.
+
+   With --timeout, a request that runs too long is stopped at the next
+   instruction, or the next step of a long number operation, with a
+   run time error and an "error" reply. */
+
+static int   batch_out = -1;	/* The real standard output. */
+static char  batch_started = FALSE;
+static char  batch_eof = FALSE;	/* There are no more requests. */
+
+static char  frame_buf[IN_BUFFER_SIZE];
+static int   frame_next = 0;	/* The next byte in frame_buf. */
+static int   frame_count = 0;	/* The number of bytes in frame_buf. */
+
+static char  in_frame = FALSE;	/* A request is being read or run. */
+static long  frame_left;	/* Bytes of the request not yet scanned. */
+static char  frame_last;	/* The last byte given to the scanner. */
+static int   frame_errors;	/* error_count at the start of the request. */
+
+
+/* Fill frame_buf from the standard input.  Returns FALSE at end of
+   file. */
+
+static int
+frame_fill (void)
+{
+  int count;
+
+  while ((count = read (0, frame_buf, IN_BUFFER_SIZE)) < 0)
+    if (errno != EINTR)
+      break;
+  frame_next = 0;
+  frame_count = (count > 0 ? count : 0);
+  return count > 0;
+}
+
+
+/* Write all of the LEN bytes at BUF to the real standard output. */
+
+static void
+batch_write (const char *buf, long len)
+{
+  ssize_t done;
+
+  while (len > 0)
+    {
+      done = write (batch_out, buf, len);
+      if (done < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  bc_exit (1);
+	}
+      buf += done;
+      len -= done;
+    }
+}
+
+
+/* Send the reply for the current request and empty the output file. */
+
+static void
+batch_reply (void)
+{
+  char *reply;
+  long len;
+  int  head;
+
+  in_frame = FALSE;
+  limit_stop ();
+  fflush (stdout);
+  len = (long) lseek (1, 0, SEEK_CUR);
+  if (len < 0)
+    len = 0;
+
+  reply = bc_malloc (len + 30);
+  head = sprintf (reply, "%s %ld\n",
+		  error_count != frame_errors ? "error" : "ok", len);
+  if (daemon_path != NULL)
+    daemon_request (error_count != frame_errors);
+  if (len > 0)
+    {
+      lseek (1, 0, SEEK_SET);
+      if (read (1, reply + head, len) != len)
+	len = 0;
+    }
+  batch_write (reply, head + len);
+  free (reply);
+
+  if (ftruncate (1, 0) != 0 || lseek (1, 0, SEEK_SET) != 0)
+    bc_exit (1);
+}
+
+
+/* Start batch mode.  The standard output and standard error are moved
+   to a temporary file that holds the output of one request. */
+
+static void
+batch_start (void)
+{
+  FILE *temp;
+
+  fflush (stdout);
+  batch_out = dup (1);
+  temp = tmpfile ();
+  if (batch_out < 0 || temp == NULL
+      || dup2 (fileno (temp), 1) < 0 || dup2 (fileno (temp), 2) < 0)
+    {
+      perror ("bc: batch");
+      bc_exit (1);
+    }
+  fclose (temp);
+  batch_started = TRUE;
+}
+
+
+/* Read the byte count line of the next request.  Returns FALSE at end
+   of file.  A bad count ends the run.  For a daemon, a "metrics" line
+   is answered here. */
+
+static int
+frame_header (void)
+{
+  char line[32], metrics[256];
+  long len;
+  int  ch, ix, mlen;
+
+  while (1)
+    {
+      /* Get the line. */
+      ix = 0;
+      while (1)
+	{
+	  if (frame_next == frame_count && !frame_fill ())
+	    {
+	      if (ix == 0)
+		return FALSE;
+	      ch = EOF;
+	    }
+	  else
+	    ch = (unsigned char) frame_buf[frame_next++];
+	  if (ch == '\n' || ch == EOF)
+	    break;
+	  if (ch != '\r' && ix < (int) sizeof (line) - 1)
+	    line[ix++] = ch;
+	}
+      line[ix] = '\0';
+
+      if (daemon_path != NULL && strcmp (line, "metrics") == 0)
+	{
+	  mlen = daemon_metrics (metrics + 16);
+	  ix = sprintf (metrics, "ok %d\n", mlen);
+	  memmove (metrics + ix, metrics + 16, mlen);
+	  batch_write (metrics, ix + mlen);
+	  continue;
+	}
+
+      len = 0;
+      for (ix = 0; isdigit ((int) line[ix]) && len <= (LONG_MAX - 9) / 10; ix++)
+	len = len * 10 + line[ix] - '0';
+      if (ix > 0 && line[ix] == '\0' && ch == '\n')
+	break;
+
+      fprintf (stderr, "Bad request header in batch mode\n");
+      error_count++;
+      in_frame = TRUE;
+      batch_reply ();
+      bc_exit (1);
+    }
+
+  frame_left = len;
+  frame_last = '\n';
+  frame_errors = error_count;
+  out_col = 0;
+  in_frame = TRUE;
+  if (daemon_path != NULL)
+    daemon_begin ();
+  limit_start ();
+  return TRUE;
+}
+
+
+/* Give the scanner up to MAX bytes of program text in BUF.  Returns
+   the number of bytes, 0 at the end of the input. */
+
+int
+batch_read (char *buf, int max)
+{
+  int len;
+
+  if (!batch_started)
+    batch_start ();
+
+  /* All of the current request has been scanned. */
+  if (in_frame && frame_left == 0 && frame_last == '\n')
+    return 0;
+
+  if (!in_frame && !frame_header ())
+    {
+      batch_eof = TRUE;
+      return 0;
+    }
+
+  /* A request that does not end with a newline gets one. */
+  if (frame_left == 0)
+    {
+      buf[0] = frame_last = '\n';
+      return 1;
+    }
+
+  if (frame_next == frame_count && !frame_fill ())
+    {
+      /* End of file in the middle of a request. */
+      frame_left = 0;
+      buf[0] = frame_last = '\n';
+      return 1;
+    }
+  len = frame_count - frame_next;
+  if (len > max)
+    len = max;
+  if (len > frame_left)
+    len = frame_left;
+  memcpy (buf, frame_buf + frame_next, len);
+  frame_next += len;
+  frame_left -= len;
+  frame_last = buf[len-1];
+  return len;
+}
+
+
+/* Called when the parse of a request has ended.  Sends the reply and
+   clears what an unfinished request left in the parser and scanner.
+   Returns FALSE if there are no more requests. */
+
+int
+batch_next (void)
+{
+  if (in_frame)
+    batch_reply ();
+  if (batch_eof)
+    return FALSE;
+
+  init_gen ();
+  cur_func = -1;
+  line_no = 1;
+  scan_reset ();
+  return TRUE;
+}
+
+
+/* Send the reply for a request that ends the run with quit or halt. */
+
+void
+batch_end (void)
+{
+  if (batch_started && in_frame)
+    batch_reply ();
+}
@@ -0,0 +1,93 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* bcapi.h: The interface for running bc inside another program. */
+
+#ifndef _BCAPI_H_
+#define _BCAPI_H_
+
+#include "number.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* An interpreter.  bc keeps its state in globals, so only one
+   interpreter may exist at a time.  It may be destroyed and another
+   created.  An interpreter must be used by one thread at a time. */
+typedef struct bc_interp bc_interp;
+
+/* The return codes. */
+#define BC_OK		0	/* Done without errors. */
+#define BC_ERROR	1	/* Errors were reported.  See bc_interp_errors. */
+#define BC_EXIT		2	/* quit, halt or a fatal error ended the
+				   interpreter.  Only destroy may follow. */
+#define BC_BADNAME	3	/* Not a variable or array name. */
+#define BC_BADINDEX	4	/* An array index out of bounds. */
+
+/* Create an interpreter, with the math library if MATHLIB is not 0.
+   Returns NULL if one already exists or memory runs out. */
+bc_interp *bc_interp_create (int mathlib);
+
+/* Destroy INTERP and free its storage. */
+void bc_interp_destroy (bc_interp *interp);
+
+/* Compile and run the program TEXT as if it were a file given to bc.
+   A missing newline at the end is supplied.  Output lines are not
+   broken.  The read function finds end of file. */
+int bc_interp_eval (bc_interp *interp, const char *text);
+
+/* Limit each bc_interp_eval to INSTRUCTIONS instructions and
+   TIMEOUT_MS milliseconds, and the numbers to MAX_MEMORY bytes.  0 is
+   no limit.  A program passing one is stopped with a runtime error and
+   BC_ERROR is returned; the interpreter may still be used.  No signal
+   is used, so the time is checked only between instructions. */
+void bc_interp_set_limits (bc_interp *interp, unsigned long instructions,
+			   long timeout_ms, size_t max_memory);
+
+/* The output and the error and warning messages of the last
+   bc_interp_eval, as strings.  LEN, if not NULL, gets the length.
+   They are good until the next call for INTERP. */
+const char *bc_interp_output (bc_interp *interp, size_t *len);
+const char *bc_interp_errors (bc_interp *interp, size_t *len);
+
+/* Get or set the variable NAME, which may also be "ibase", "obase",
+   "scale" or "last".  A number got is a new reference that the caller
+   frees with bc_free_num.  A number set is copied. */
+int bc_interp_get_var (bc_interp *interp, const char *name, bc_num *value);
+int bc_interp_set_var (bc_interp *interp, const char *name, bc_num value);
+
+/* Get or set element INDEX of the array NAME. */
+int bc_interp_get_array (bc_interp *interp, const char *name,
+			 unsigned long index, bc_num *value);
+int bc_interp_set_array (bc_interp *interp, const char *name,
+			 unsigned long index, bc_num value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <ctype.h>
+#include <setjmp.h>
 #ifdef HAVE_STRING_H
 #include <string.h>
 #else
@@ -92,6 +93,14 @@ typedef struct arg_list
       struct arg_list *next;
     } arg_list;
 
+/* The code of a function from L_ADDR on comes from source line
+   L_LINE, until the next entry. */
+
+typedef struct {
+      unsigned long l_addr;
+      int l_line;
+    } bc_line_rec;
+
 /* Each function has its own code segments and labels.  There can be
    no jumps between functions so labels are unique to a function. */
 
@@ -99,12 +108,17 @@ typedef struct
     {
       char f_defined;   /* Is this function defined yet. */
       char f_void;	/* Is this function a void function. */
+      char f_builtin;	/* Builtin used when not defined, 0 for none. */
       char *f_body;
       size_t f_body_size;  /* Size of body.  Power of 2. */
       size_t f_code_size;
       bc_label_group *f_label;
       arg_list *f_params;
       arg_list *f_autos;
+      bc_line_rec *f_lines; /* The source line of each run of code. */
+      int f_line_count;
+      int f_line_size;
+      const char *f_file;   /* The source file of the lines. */
     } bc_function;
 
 /* Code addresses. */
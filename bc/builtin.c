@@ -0,0 +1,776 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* builtin.c - functions written in C rather than in bc. */
+
+#include "bcdefs.h"
+#include "proto.h"
+#include <time.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+/* A builtin is called like any other function.  It is only used when
+   no bc function of the same name has been defined, so a user's own
+   definition always wins.  The arguments are in call order in ARGS
+   and the value is placed in RESULT.  An array argument is passed as
+   its array number.  Errors are reported with rt_error. */
+
+typedef void (*bc_builtin_func) (bc_num *args, int nargs, bc_num *result);
+
+typedef struct {
+      const char *b_name;
+      char b_min_args;	/* Fewest arguments accepted. */
+      char b_max_args;	/* Most arguments accepted. */
+      char b_mathlib;	/* Part of the math library (-l), or BI_FLOAT. */
+      const char *b_arrays; /* '1' for each array parameter, or NULL. */
+      bc_builtin_func b_func;
+    } bc_builtin;
+
+/* b_mathlib for a builtin used in place of a math library function
+   with --float. */
+#define BI_FLOAT 2
+
+/* The most arguments any builtin takes. */
+#define BUILTIN_MAX_ARGS 5
+
+static void bi_bessel_j (bc_num *args, int nargs, bc_num *result);
+static void bi_constant (bc_num *args, int nargs, bc_num *result);
+static void bi_pi (bc_num *args, int nargs, bc_num *result);
+static void bi_euler (bc_num *args, int nargs, bc_num *result);
+static void bi_hyper (bc_num *args, int nargs, bc_num *result);
+static void bi_isprime (bc_num *args, int nargs, bc_num *result);
+static void bi_nextprime (bc_num *args, int nargs, bc_num *result);
+static void bi_gcd (bc_num *args, int nargs, bc_num *result);
+static void bi_lcm (bc_num *args, int nargs, bc_num *result);
+static void bi_modinv (bc_num *args, int nargs, bc_num *result);
+static void bi_jacobi (bc_num *args, int nargs, bc_num *result);
+static void bi_factorial (bc_num *args, int nargs, bc_num *result);
+static void bi_binomial (bc_num *args, int nargs, bc_num *result);
+static void bi_fib (bc_num *args, int nargs, bc_num *result);
+static void bi_lucas (bc_num *args, int nargs, bc_num *result);
+static void bi_and (bc_num *args, int nargs, bc_num *result);
+static void bi_or (bc_num *args, int nargs, bc_num *result);
+static void bi_xor (bc_num *args, int nargs, bc_num *result);
+static void bi_not (bc_num *args, int nargs, bc_num *result);
+static void bi_shl (bc_num *args, int nargs, bc_num *result);
+static void bi_shr (bc_num *args, int nargs, bc_num *result);
+static void bi_popcount (bc_num *args, int nargs, bc_num *result);
+static void bi_bitlen (bc_num *args, int nargs, bc_num *result);
+static void bi_iroot (bc_num *args, int nargs, bc_num *result);
+static void bi_rand (bc_num *args, int nargs, bc_num *result);
+static void bi_srand (bc_num *args, int nargs, bc_num *result);
+#ifdef HAVE_MPFR
+static void bi_float_e (bc_num *args, int nargs, bc_num *result);
+static void bi_float_l (bc_num *args, int nargs, bc_num *result);
+static void bi_float_s (bc_num *args, int nargs, bc_num *result);
+static void bi_float_c (bc_num *args, int nargs, bc_num *result);
+static void bi_float_a (bc_num *args, int nargs, bc_num *result);
+#endif
+
+/* The table of builtins.  Index 0 is unused so that 0 can mean
+   "no builtin" in the function table. */
+
+static const bc_builtin builtins[] = {
+  { NULL, 0, 0, FALSE, NULL, NULL },
+  { "j", 2, 2, TRUE, NULL, bi_bessel_j },
+  { "const", 1, 1, TRUE, NULL, bi_constant },
+  { "pi", 0, 0, FALSE, NULL, bi_pi },
+  { "euler", 0, 0, FALSE, NULL, bi_euler },
+  { "hyper", 5, 5, FALSE, "10100", bi_hyper },
+  { "isprime", 1, 1, FALSE, NULL, bi_isprime },
+  { "nextprime", 1, 1, FALSE, NULL, bi_nextprime },
+  { "gcd", 2, 2, FALSE, NULL, bi_gcd },
+  { "lcm", 2, 2, FALSE, NULL, bi_lcm },
+  { "modinv", 2, 2, FALSE, NULL, bi_modinv },
+  { "jacobi", 2, 2, FALSE, NULL, bi_jacobi },
+  { "factorial", 1, 1, FALSE, NULL, bi_factorial },
+  { "binomial", 2, 2, FALSE, NULL, bi_binomial },
+  { "fib", 1, 1, FALSE, NULL, bi_fib },
+  { "lucas", 1, 1, FALSE, NULL, bi_lucas },
+  { "and", 2, 2, FALSE, NULL, bi_and },
+  { "or", 2, 2, FALSE, NULL, bi_or },
+  { "xor", 2, 2, FALSE, NULL, bi_xor },
+  { "not", 1, 1, FALSE, NULL, bi_not },
+  { "shl", 2, 2, FALSE, NULL, bi_shl },
+  { "shr", 2, 2, FALSE, NULL, bi_shr },
+  { "popcount", 1, 1, FALSE, NULL, bi_popcount },
+  { "bitlen", 1, 1, FALSE, NULL, bi_bitlen },
+  { "iroot", 2, 2, FALSE, NULL, bi_iroot },
+  { "rand", 0, 1, FALSE, NULL, bi_rand },
+  { "srand", 1, 1, FALSE, NULL, bi_srand },
+#ifdef HAVE_MPFR
+  { "e", 1, 1, BI_FLOAT, NULL, bi_float_e },
+  { "l", 1, 1, BI_FLOAT, NULL, bi_float_l },
+  { "s", 1, 1, BI_FLOAT, NULL, bi_float_s },
+  { "c", 1, 1, BI_FLOAT, NULL, bi_float_c },
+  { "a", 1, 1, BI_FLOAT, NULL, bi_float_a },
+#endif
+};
+
+#define BUILTIN_COUNT ((int) (sizeof (builtins) / sizeof (builtins[0])))
+
+
+/* find_builtin returns the builtin number for NAME or 0 if there is
+   no builtin by that name. */
+
+int
+find_builtin (const char *name)
+{
+  int ix;
+
+  for (ix = 1; ix < BUILTIN_COUNT; ix++)
+    if (strcmp (name, builtins[ix].b_name) == 0)
+      return ix;
+  return 0;
+}
+
+
+/* Is NAME a math library builtin?  With -l these names are part of
+   the language even when longer than one letter. */
+
+int
+mathlib_builtin (const char *name)
+{
+  int ix;
+
+  ix = find_builtin (name);
+  return ix != 0 && builtins[ix].b_mathlib;
+}
+
+
+/* Can the builtin for function FUNC be used in this run?  Math
+   library builtins need -l and the float ones --float.  All others
+   are extensions and are not available with -s. */
+
+int
+builtin_available (int func)
+{
+  const bc_builtin *bi;
+
+  if (functions[func].f_builtin == 0)
+    return FALSE;
+  bi = &builtins[(int) functions[func].f_builtin];
+  if (bi->b_mathlib == BI_FLOAT)
+    return float_mode;
+  if (bi->b_mathlib)
+    return use_math;
+  return !std_only;
+}
+
+
+/* Call the builtin for function FUNC.  The parameter types are at
+   PROGCTR just as for a call to a bc function and the arguments are
+   on the execution stack.  The arguments are replaced by the value. */
+
+void
+call_builtin (program_counter *progctr, int func)
+{
+  const bc_builtin *bi;
+  bc_num args[BUILTIN_MAX_ARGS];
+  bc_num result;
+  estack_rec *arg;
+  int nargs, ix;
+  char ch, types[BUILTIN_MAX_ARGS];
+
+  bi = &builtins[(int) functions[func].f_builtin];
+
+  /* Get the parameter types.  They are in reverse order. */
+  nargs = 0;
+  while ((ch = byte(progctr)) != ':')
+    {
+      if (nargs < BUILTIN_MAX_ARGS)
+	types[nargs] = ch;
+      nargs++;
+    }
+  if (nargs < bi->b_min_args || nargs > bi->b_max_args)
+    {
+      rt_error ("Parameter number mismatch");
+      return;
+    }
+  for (ix = 0; ix < nargs; ix++)
+    if (types[nargs-1-ix] != (bi->b_arrays == NULL ? '0' : bi->b_arrays[ix]))
+      {
+	rt_error ("Parameter type mismatch, parameter %d of %s.",
+		  ix+1, f_names[func]);
+	return;
+      }
+  if (!check_stack (nargs)) return;
+
+  /* The last argument is on the top of the stack. */
+  for (ix = nargs-1, arg = ex_stack; ix >= 0; ix--, arg = arg->s_next)
+    args[ix] = arg->s_num;
+
+  bc_init_num (&result);
+  (*bi->b_func) (args, nargs, &result);
+
+  for (ix = 0; ix < nargs; ix++)
+    pop ();
+  if (runtime_error)
+    bc_free_num (&result);
+  else
+    push_num (result);
+}
+
+
+/* Bessel function of integer order.  This gives exactly the digits
+   of the bc version that used to be in libmath.b:
+     j(-n,x) = (-1)^n*j(n,x)
+     j(n,x) = x^n/(2^n*n!) * (1 - x^2/(2^2*1!*(n+1)) + x^4/(2^4*2!*(n+1)*(n+2))
+              - x^6/(2^6*3!*(n+1)*(n+2)*(n+3)) .... )
+   Since truncating divisions nest, x^n/2^n/n! is one division by
+   2^n*n! and each term needs one division by i*(n+i).  The divisor
+   2^n*n! is kept from call to call, as a table is usually made for
+   one order over many values of x. */
+
+static bc_num j_divisor = NULL;	/* 2^n*n! for the order below. */
+static long   j_order = -1;
+
+static void
+bi_bessel_j (bc_num *args, int nargs, bc_num *result)
+{
+  bc_num order, x, f, s, v, e, temp;
+  long n, i, z, fscale, sscale;
+  char neg;
+
+  /* Make n an integer and check for negative n. */
+  z = scale;
+  order = NULL;
+  bc_divide (args[0], _one_, &order, 0);
+  n = bc_num2long (order);
+  if (n == 0 && !bc_is_zero (order))
+    {
+      rt_error ("order too large in j");
+      bc_free_num (&order);
+      return;
+    }
+  neg = FALSE;
+  if (n < 0)
+    {
+      n = -n;
+      bc_neg (&order);
+      neg = (n % 2 == 1);
+    }
+  x = args[1];
+
+  /* The divisor 2^n*n!. */
+  if (n != j_order)
+    {
+      temp = NULL;
+      bc_factorial (n, &j_divisor);
+      bc_raise (_two_, order, &temp, 0);
+      bc_multiply (j_divisor, temp, &j_divisor, 0);
+      bc_free_num (&temp);
+      j_order = n;
+    }
+
+  /* Compute the factor of x^n/(2^n*n!) */
+  fscale = 3*z/2;
+  f = NULL;
+  bc_raise (x, order, &f, fscale);
+  bc_divide (f, j_divisor, &f, fscale);
+  bc_free_num (&order);
+
+  /* Initialize the loop. */
+  s = NULL;
+  bc_multiply (x, x, &s, fscale);
+  bc_neg (&s);
+  bc_divide_ui (s, 4, &s, fscale);
+  if (bc_num_length (f) <= bc_num_scale (f))
+    sscale = fscale;
+  else
+    sscale = fscale + bc_num_length (f) - bc_num_scale (f);
+  v = bc_copy_num (_one_);
+  e = bc_copy_num (_one_);
+
+  /* The Loop.... */
+  for (i = 1; !bc_is_zero (e); i++)
+    {
+      bc_multiply (e, s, &e, sscale);
+      if ((unsigned long) n + i <= ULONG_MAX / i)
+	bc_divide_ui (e, i * (n+i), &e, sscale);
+      else
+	{
+	  bc_divide_ui (e, i, &e, sscale);
+	  bc_divide_ui (e, n+i, &e, sscale);
+	}
+      bc_add (v, e, &v, 0);
+    }
+
+  /* Assign the value. */
+  bc_multiply (f, v, result, z);
+  bc_divide (*result, _one_, result, z);
+  if (neg)
+    bc_neg (result);
+
+  bc_free_num (&f);
+  bc_free_num (&s);
+  bc_free_num (&v);
+  bc_free_num (&e);
+}
+
+
+/* const(n) is a mathematical constant to scale digits: 0 is pi, 1 is
+   ln(2), 2 is ln(10) and 3 is e.  The values are kept by bc_constant,
+   so only the first use at a higher scale does any work. */
+
+static void
+bi_constant (bc_num *args, int nargs, bc_num *result)
+{
+  bc_num which;
+  long n;
+
+  which = NULL;
+  bc_divide (args[0], _one_, &which, 0);
+  n = bc_num2long (which);
+  if ((n == 0 && !bc_is_zero (which)) || n < 0 || n >= BC_NUM_CONSTANTS)
+    rt_error ("No such constant in const");
+  else
+    bc_constant ((int) n, scale, result);
+  bc_free_num (&which);
+}
+
+
+/* pi() and euler() are pi and e to scale digits.  They are summed by
+   binary splitting and kept by bc_constant. */
+
+static void
+bi_pi (bc_num *args, int nargs, bc_num *result)
+{
+  bc_constant (BC_PI, scale, result);
+}
+
+static void
+bi_euler (bc_num *args, int nargs, bc_num *result)
+{
+  bc_constant (BC_E, scale, result);
+}
+
+
+/* Get the count of parameters in ARG for hyper and check it. */
+
+static int
+hyper_count (bc_num arg, const char *what)
+{
+  long count;
+
+  count = bc_num2long (arg);
+  if (count < 0 || count > BC_DIM_MAX)
+    {
+      rt_error ("Bad %s count in hyper", what);
+      return -1;
+    }
+  return (int) count;
+}
+
+/* Get the first COUNT elements of the array ARG. */
+
+static bc_num *
+hyper_params (bc_num arg, int count)
+{
+  bc_num *params, *elem;
+  int ix;
+
+  params = bc_malloc ((count + 1) * sizeof (bc_num));
+  for (ix = 0; ix < count; ix++)
+    {
+      elem = get_array_num ((int) bc_num2long (arg), ix);
+      if (elem == NULL)
+	{
+	  free (params);
+	  return NULL;
+	}
+      params[ix] = *elem;
+    }
+  return params;
+}
+
+/* hyper(a[],p,b[],q,z) is the generalized hypergeometric series
+   pFq(a[0]..a[p-1]; b[0]..b[q-1]; z) to scale digits. */
+
+static void
+bi_hyper (bc_num *args, int nargs, bc_num *result)
+{
+  bc_num *a, *b;
+  int p, q;
+
+  if ((p = hyper_count (args[1], "a")) < 0
+      || (q = hyper_count (args[3], "b")) < 0)
+    return;
+  a = hyper_params (args[0], p);
+  b = hyper_params (args[2], q);
+  if (a != NULL && b != NULL)
+    switch (bc_hypergeometric (a, p, b, q, args[4], scale, result))
+      {
+      case -1:
+	rt_error ("b is zero or a negative integer in hyper");
+	break;
+      case -2:
+	rt_error ("hyper series does not converge");
+	break;
+      }
+  if (a != NULL) free (a);
+  if (b != NULL) free (b);
+}
+
+
+/* Number theory.  These use the integer part of their arguments. */
+
+/* The number of Miller-Rabin rounds for isprime.  A composite passes
+   all of them with a chance of less than 4^-PRIME_REPS. */
+#define PRIME_REPS 25
+
+/* isprime(n) is 1 if n is (very probably) prime, 0 if not. */
+
+static void
+bi_isprime (bc_num *args, int nargs, bc_num *result)
+{
+  bc_int2num (result, bc_isprime (args[0], PRIME_REPS) != 0);
+}
+
+/* nextprime(n) is the first prime greater than n. */
+
+static void
+bi_nextprime (bc_num *args, int nargs, bc_num *result)
+{
+  bc_nextprime (args[0], result);
+}
+
+static void
+bi_gcd (bc_num *args, int nargs, bc_num *result)
+{
+  bc_gcd (args[0], args[1], result);
+}
+
+static void
+bi_lcm (bc_num *args, int nargs, bc_num *result)
+{
+  bc_lcm (args[0], args[1], result);
+}
+
+/* modinv(a,m) is the x from 0 to |m|-1 with a*x % m == 1. */
+
+static void
+bi_modinv (bc_num *args, int nargs, bc_num *result)
+{
+  if (bc_modinv (args[0], args[1], result) < 0)
+    rt_error ("No inverse in modinv");
+}
+
+/* jacobi(a,n) is the Jacobi symbol (a/n) for an odd n > 0. */
+
+static void
+bi_jacobi (bc_num *args, int nargs, bc_num *result)
+{
+  int res;
+
+  res = bc_jacobi (args[0], args[1]);
+  if (res == -2)
+    rt_error ("jacobi needs an odd, positive n");
+  else
+    bc_int2num (result, res);
+}
+
+
+/* Combinatorics.  GMP computes these with product trees and doubling
+   formulas, far faster than a loop in bc. */
+
+/* Get the integer part of ARG as a count for FUNC.  Returns -1 with
+   an error if it is negative or too large. */
+
+static long
+count_arg (bc_num arg, const char *func)
+{
+  bc_num whole;
+  long count;
+
+  whole = NULL;
+  bc_divide (arg, _one_, &whole, 0);
+  count = bc_num2long (whole);
+  if (count < 0 || (count == 0 && !bc_is_zero (whole)))
+    {
+      rt_error ("Bad argument to %s", func);
+      count = -1;
+    }
+  bc_free_num (&whole);
+  return count;
+}
+
+static void
+bi_factorial (bc_num *args, int nargs, bc_num *result)
+{
+  long n;
+
+  if ((n = count_arg (args[0], "factorial")) >= 0)
+    bc_factorial (n, result);
+}
+
+/* binomial(n,k) is 0 for a negative k.  n may be negative. */
+
+static void
+bi_binomial (bc_num *args, int nargs, bc_num *result)
+{
+  bc_num k;
+  long count;
+
+  k = NULL;
+  bc_divide (args[1], _one_, &k, 0);
+  if (bc_is_neg (k))
+    bc_int2num (result, 0);
+  else if ((count = count_arg (k, "binomial")) >= 0)
+    bc_binomial (args[0], count, result);
+  bc_free_num (&k);
+}
+
+static void
+bi_fib (bc_num *args, int nargs, bc_num *result)
+{
+  long n;
+
+  if ((n = count_arg (args[0], "fib")) >= 0)
+    bc_fibonacci (n, result);
+}
+
+static void
+bi_lucas (bc_num *args, int nargs, bc_num *result)
+{
+  long n;
+
+  if ((n = count_arg (args[0], "lucas")) >= 0)
+    bc_lucas (n, result);
+}
+
+
+/* Bit operations on integers.  Negative numbers act as two's
+   complement with an infinite sign extension. */
+
+static void
+not_integer (const char *func)
+{
+  rt_error ("Non-integer argument to %s", func);
+}
+
+static void
+bi_and (bc_num *args, int nargs, bc_num *result)
+{
+  if (bc_logic ('&', args[0], args[1], result) < 0)
+    not_integer ("and");
+}
+
+static void
+bi_or (bc_num *args, int nargs, bc_num *result)
+{
+  if (bc_logic ('|', args[0], args[1], result) < 0)
+    not_integer ("or");
+}
+
+static void
+bi_xor (bc_num *args, int nargs, bc_num *result)
+{
+  if (bc_logic ('^', args[0], args[1], result) < 0)
+    not_integer ("xor");
+}
+
+/* not(a) is -a-1. */
+
+static void
+bi_not (bc_num *args, int nargs, bc_num *result)
+{
+  if (bc_logic ('~', args[0], NULL, result) < 0)
+    not_integer ("not");
+}
+
+/* shl(a,n) is a*2^n. */
+
+static void
+bi_shl (bc_num *args, int nargs, bc_num *result)
+{
+  long bits;
+
+  if ((bits = count_arg (args[1], "shl")) >= 0
+      && bc_shift (args[0], bits, result) < 0)
+    not_integer ("shl");
+}
+
+/* shr(a,n) is a/2^n rounded towards minus infinity. */
+
+static void
+bi_shr (bc_num *args, int nargs, bc_num *result)
+{
+  long bits;
+
+  if ((bits = count_arg (args[1], "shr")) >= 0
+      && bc_shift (args[0], -bits, result) < 0)
+    not_integer ("shr");
+}
+
+static void
+bi_popcount (bc_num *args, int nargs, bc_num *result)
+{
+  long count;
+
+  count = bc_popcount (args[0]);
+  if (count == -1)
+    not_integer ("popcount");
+  else if (count == -2)
+    rt_error ("Negative argument to popcount");
+  else
+    bc_int2num (result, count);
+}
+
+static void
+bi_bitlen (bc_num *args, int nargs, bc_num *result)
+{
+  long len;
+
+  if ((len = bc_bitlen (args[0])) < 0)
+    not_integer ("bitlen");
+  else
+    bc_int2num (result, len);
+}
+
+/* iroot(a,n) is the integer part of the nth root of a. */
+
+static void
+bi_iroot (bc_num *args, int nargs, bc_num *result)
+{
+  long n;
+
+  if ((n = count_arg (args[1], "iroot")) < 0)
+    return;
+  if (n == 0)
+    {
+      rt_error ("Zero root in iroot");
+      return;
+    }
+  switch (bc_iroot (args[0], n, result))
+    {
+    case -1:
+      not_integer ("iroot");
+      break;
+    case -2:
+      rt_error ("Even root of a negative number in iroot");
+      break;
+    }
+}
+
+
+/* Random numbers.  Unless srand is called first, the generator is
+   seeded from the clock and process id so each run differs. */
+
+static char rand_seeded = FALSE;
+
+/* rand() is uniform in [0,1) with scale digits.  rand(n) is an integer
+   from 0 to n-1. */
+
+static void
+bi_rand (bc_num *args, int nargs, bc_num *result)
+{
+  bc_num seed;
+
+  if (!rand_seeded)
+    {
+      seed = NULL;
+      bc_int2num (&seed, (int) (((unsigned long) time (NULL)
+				 ^ ((unsigned long) getpid () << 16))
+				& INT_MAX));
+      bc_srandom (seed);
+      bc_free_num (&seed);
+      rand_seeded = TRUE;
+    }
+  if (bc_random (nargs == 1 ? args[0] : NULL, scale, result) < 0)
+    rt_error ("rand bound is not positive");
+}
+
+/* srand(s) restarts the generator with seed s.  Its value is 0. */
+
+static void
+bi_srand (bc_num *args, int nargs, bc_num *result)
+{
+  bc_srandom (args[0]);
+  rand_seeded = TRUE;
+  bc_int2num (result, 0);
+}
+
+
+#ifdef HAVE_MPFR
+/* The math library functions for --float, computed by MPFR at about
+   scale digits.  The value is truncated to scale digits, but it is
+   not always the one the exact decimal computation gives. */
+
+static void
+float_call (bc_mpfr_func func, const char *name, bc_num x, bc_num *result)
+{
+  if (bc_float (func, x, scale, result) < 0)
+    rt_error ("Value too large in %s", name);
+}
+
+static void
+bi_float_e (bc_num *args, int nargs, bc_num *result)
+{
+  float_call (mpfr_exp, "e", args[0], result);
+}
+
+/* l(x) for x <= 0 is 1-10^scale, as in the math library. */
+
+static void
+bi_float_l (bc_num *args, int nargs, bc_num *result)
+{
+  bc_num ten, power;
+
+  if (bc_is_neg (args[0]) || bc_is_zero (args[0]))
+    {
+      ten = power = NULL;
+      bc_int2num (&ten, 10);
+      bc_int2num (&power, scale);
+      bc_raise (ten, power, result, 0);
+      bc_sub (_one_, *result, result, 0);
+      bc_divide (*result, _one_, result, scale);
+      bc_free_num (&ten);
+      bc_free_num (&power);
+      return;
+    }
+  float_call (mpfr_log, "l", args[0], result);
+}
+
+static void
+bi_float_s (bc_num *args, int nargs, bc_num *result)
+{
+  float_call (mpfr_sin, "s", args[0], result);
+}
+
+static void
+bi_float_c (bc_num *args, int nargs, bc_num *result)
+{
+  float_call (mpfr_cos, "c", args[0], result);
+}
+
+static void
+bi_float_a (bc_num *args, int nargs, bc_num *result)
+{
+  float_call (mpfr_atan, "a", args[0], result);
+}
+#endif
@@ -69,6 +69,20 @@
 #define BC_LABEL_LOG    6
 #define BC_START_SIZE  1024	/* Initial code body size. */
 
+/* The sizes of the buffers for the read function and for output when
+   not interactive. */
+
+#define IN_BUFFER_SIZE  65536
+#define OUT_BUFFER_SIZE 65536
+
+/* The values of limit_hit, and the instructions between looks at the
+   limits of a run. */
+
+#define LIMIT_TIME         1
+#define LIMIT_INSTRUCTIONS 2
+#define LIMIT_REPORTED     3
+#define LIMIT_STEP      4096
+
 /* Maximum number of variables, arrays and functions and the
    allocation increment for the dynamic arrays. */
 
@@ -0,0 +1,337 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* daemon.c - serve batch requests on a Unix domain socket. */
+
+#include "bcdefs.h"
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "proto.h"
+
+/* With --daemon, bc runs the files named on the command line, with
+   the math library if asked for, and then listens on a Unix domain
+   socket instead of reading the standard input.
+
+   The interpreter keeps its state in globals, so the workers are
+   processes rather than threads.  A pool of workers is forked after
+   the files have been run, so each starts with the compiled functions
+   and variables already in place and shares them with the others
+   until it changes them.  A worker takes one connection and serves it
+   in batch mode, so each client gets a fresh copy of the loaded state.
+   When the connection closes the worker exits and the master forks
+   another to take its place.
+
+   A connection may send the line "metrics" instead of a request to
+   get the counts below as an "ok" reply.
+
+   With --timeout a request is stopped between the steps of its
+   number operations, but a single GMP call can not be stopped.  So
+   the master looks at the workers as the timer ticks and kills one
+   whose request has run twice the limit.  Its client sees the
+   connection close without a reply. */
+
+typedef struct {
+      long d_connections;	/* Connections accepted. */
+      long d_requests;		/* Requests answered. */
+      long d_errors;		/* Requests answered with "error". */
+      long d_timeouts;		/* Requests stopped by --timeout. */
+      long d_busy;		/* Workers serving a connection now. */
+    } daemon_stats;
+
+/* The counts are in memory shared by the master and all workers. */
+static daemon_stats *stats = NULL;
+
+static int    listen_fd = -1;
+static pid_t *workers;		/* The process of each worker or 0. */
+static char  *serving;		/* Worker I has taken a connection. */
+static long  *began;		/* When worker I's request began, or 0. */
+static int    worker_slot;	/* This worker's I. */
+static volatile sig_atomic_t daemon_stop = FALSE;
+
+
+static void
+daemon_term (int sig)
+{
+  daemon_stop = TRUE;
+}
+
+
+/* The master's timer only has to stop the wait. */
+
+static void
+daemon_tick (int sig)
+{
+}
+
+
+/* The milliseconds since some fixed time, never 0. */
+
+static long
+daemon_clock (void)
+{
+  struct timespec now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000L + now.tv_nsec / 1000000 + 1;
+}
+
+
+/* Add ONE to the count at COUNT.  Workers update the counts at once. */
+
+static void
+daemon_add (long *count, long one)
+{
+  __sync_fetch_and_add (count, one);
+}
+
+
+/* Kill the workers whose request has run twice the time limit. */
+
+static void
+daemon_overdue (void)
+{
+  long now;
+  int ix;
+
+  now = daemon_clock ();
+  for (ix = 0; ix < daemon_workers; ix++)
+    if (workers[ix] > 0 && began[ix] != 0
+	&& now - began[ix] > 2 * time_limit)
+      {
+	began[ix] = 0;
+	daemon_add (&stats->d_timeouts, 1);
+	kill (workers[ix], SIGKILL);
+      }
+}
+
+
+/* The part of a worker before it runs bc: wait for a connection and
+   make it the standard input and output. */
+
+static void
+worker_start (int slot)
+{
+  int conn;
+
+  signal (SIGTERM, SIG_DFL);
+  signal (SIGINT, SIG_DFL);
+  while ((conn = accept (listen_fd, NULL, NULL)) < 0)
+    if (errno != EINTR && errno != ECONNABORTED)
+      {
+	perror ("bc: accept");
+	_exit (1);
+      }
+  close (listen_fd);
+  worker_slot = slot;
+  serving[slot] = TRUE;
+  daemon_add (&stats->d_connections, 1);
+  daemon_add (&stats->d_busy, 1);
+
+  if (dup2 (conn, 0) < 0 || dup2 (conn, 1) < 0)
+    _exit (1);
+  close (conn);
+}
+
+
+/* Fork the worker for SLOT.  Returns TRUE in the new worker. */
+
+static int
+worker_fork (int slot)
+{
+  pid_t pid;
+
+  serving[slot] = FALSE;
+  began[slot] = 0;
+  pid = fork ();
+  if (pid == 0)
+    {
+      worker_start (slot);
+      return TRUE;
+    }
+  workers[slot] = (pid > 0 ? pid : 0);
+  return FALSE;
+}
+
+
+/* Start the daemon.  This returns only in a worker, with a client
+   connection as the standard input and output.  The master stays here
+   until it gets SIGTERM or SIGINT. */
+
+void
+daemon_start (void)
+{
+  struct sockaddr_un addr;
+  struct sigaction act;
+  struct itimerval timer;
+  pid_t pid;
+  long tick;
+  int ix, status;
+
+  fflush (stdout);
+  signal (SIGPIPE, SIG_IGN);
+
+  stats = mmap (NULL, sizeof (daemon_stats)
+		+ daemon_workers * (sizeof (long) + 1),
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (stats == MAP_FAILED)
+    {
+      perror ("bc: mmap");
+      bc_exit (1);
+    }
+  memset (stats, 0, sizeof (daemon_stats));
+  began = (long *) (stats + 1);
+  serving = (char *) (began + daemon_workers);
+
+  if (strlen (daemon_path) >= sizeof (addr.sun_path))
+    {
+      fprintf (stderr, "bc: socket name %s is too long\n", daemon_path);
+      bc_exit (1);
+    }
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, daemon_path);
+  unlink (daemon_path);
+  listen_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0
+      || bind (listen_fd, (struct sockaddr *) &addr, sizeof (addr)) < 0
+      || listen (listen_fd, SOMAXCONN) < 0)
+    {
+      perror (daemon_path);
+      bc_exit (1);
+    }
+
+  /* Without SA_RESTART, so that wait returns. */
+  memset (&act, 0, sizeof (act));
+  act.sa_handler = daemon_term;
+  sigaction (SIGTERM, &act, NULL);
+  sigaction (SIGINT, &act, NULL);
+  if (time_limit > 0)
+    {
+      act.sa_handler = daemon_tick;
+      sigaction (SIGALRM, &act, NULL);
+    }
+  workers = bc_malloc (daemon_workers * sizeof (pid_t));
+  for (ix = 0; ix < daemon_workers; ix++)
+    if (worker_fork (ix))
+      return;
+
+  /* Look for overdue workers at every half of the time limit.  The
+     timer is the master's alone; a fork does not inherit it. */
+  if (time_limit > 0)
+    {
+      tick = time_limit / 2 + 1;
+      timer.it_interval.tv_sec = tick / 1000;
+      timer.it_interval.tv_usec = (tick % 1000) * 1000;
+      timer.it_value = timer.it_interval;
+      setitimer (ITIMER_REAL, &timer, NULL);
+    }
+
+  /* Replace each worker as it exits. */
+  while (!daemon_stop)
+    {
+      pid = wait (&status);
+      if (pid < 0)
+	{
+	  if (errno == EINTR)
+	    {
+	      if (time_limit > 0)
+		daemon_overdue ();
+	      continue;
+	    }
+	  break;
+	}
+      for (ix = 0; ix < daemon_workers; ix++)
+	if (workers[ix] == pid)
+	  {
+	    if (serving[ix])
+	      daemon_add (&stats->d_busy, -1);
+	    if (!daemon_stop && worker_fork (ix))
+	      return;
+	    break;
+	  }
+    }
+
+  for (ix = 0; ix < daemon_workers; ix++)
+    if (workers[ix] > 0)
+      kill (workers[ix], SIGTERM);
+  unlink (daemon_path);
+  bc_exit (0);
+}
+
+
+/* Note that this worker has begun a request. */
+
+void
+daemon_begin (void)
+{
+  if (stats != NULL)
+    began[worker_slot] = daemon_clock ();
+}
+
+
+/* Count a request answered by this worker. */
+
+void
+daemon_request (int error)
+{
+  if (stats == NULL)
+    return;
+  began[worker_slot] = 0;
+  daemon_add (&stats->d_requests, 1);
+  if (error)
+    daemon_add (&stats->d_errors, 1);
+}
+
+
+/* Count a request stopped by the time limit.  This is called by
+   execute when it reports the limit. */
+
+void
+daemon_timeout (void)
+{
+  if (stats != NULL)
+    daemon_add (&stats->d_timeouts, 1);
+}
+
+
+/* Write the counts into BUF, which holds at least 256 characters.
+   Returns the length. */
+
+int
+daemon_metrics (char *buf)
+{
+  return sprintf (buf,
+		  "workers %d\nbusy %ld\nconnections %ld\nrequests %ld\n"
+		  "errors %ld\ntimeouts %ld\n",
+		  daemon_workers, stats->d_busy, stats->d_connections,
+		  stats->d_requests, stats->d_errors, stats->d_timeouts);
+}
@@ -28,6 +28,9 @@
 
 #include "bcdefs.h"
 #include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
 #include "proto.h"
 
 
@@ -42,6 +45,120 @@ stop_execution ( int sig )
 }
 
 
+/* The limits of a run.  limit_step counts down the instructions and
+   at 0 limit_check takes the next step from the budget and looks at
+   the clock, so the loop pays one decrement and test for both.  When
+   bc is not embedded a timer also sets bc_cancel, which stops the long
+   number operations between their steps. */
+
+static long limit_step = LIMIT_STEP;
+static unsigned long insts_left;
+static struct timespec deadline;
+static char limit_timer = FALSE;
+
+/* The timer of the time limit.  The run stops at the next step of a
+   long number operation, or after a single GMP call, and the limit is
+   reported as usual, so a batch request still gets its reply. */
+
+static void
+limit_alarm (int sig)
+{
+  if (limit_hit == 0)
+    limit_hit = LIMIT_TIME;
+  bc_cancel = TRUE;
+}
+
+/* Start the limits of a run. */
+
+void
+limit_start (void)
+{
+  struct itimerval timer;
+
+  limit_hit = 0;
+  bc_cancel = FALSE;
+  insts_left = max_instructions;
+  limit_step = 1;
+  if (time_limit > 0)
+    {
+      clock_gettime (CLOCK_MONOTONIC, &deadline);
+      deadline.tv_sec += time_limit / 1000;
+      deadline.tv_nsec += (time_limit % 1000) * 1000000;
+      if (deadline.tv_nsec >= 1000000000)
+	{
+	  deadline.tv_sec++;
+	  deadline.tv_nsec -= 1000000000;
+	}
+
+      /* An embedded interpreter sets no signal handler. */
+      if (exit_jump == NULL)
+	{
+	  signal (SIGALRM, limit_alarm);
+	  timer.it_interval.tv_sec = time_limit / 1000;
+	  timer.it_interval.tv_usec = (time_limit % 1000) * 1000;
+	  timer.it_value = timer.it_interval;
+	  setitimer (ITIMER_REAL, &timer, NULL);
+	  limit_timer = TRUE;
+	}
+    }
+}
+
+static void
+limit_timer_off (void)
+{
+  struct itimerval timer;
+
+  if (limit_timer)
+    {
+      memset (&timer, 0, sizeof (timer));
+      setitimer (ITIMER_REAL, &timer, NULL);
+      limit_timer = FALSE;
+    }
+}
+
+/* End the run.  Its limits no longer apply. */
+
+void
+limit_stop (void)
+{
+  limit_timer_off ();
+  limit_hit = 0;
+  bc_cancel = FALSE;
+}
+
+/* LIMIT_STEP more instructions.  Returns TRUE if a limit is passed. */
+
+static int
+limit_check (void)
+{
+  struct timespec now;
+
+  limit_step = LIMIT_STEP;
+  if (max_instructions != 0)
+    {
+      if (insts_left == 0)
+	{
+	  limit_hit = LIMIT_INSTRUCTIONS;
+	  return TRUE;
+	}
+      if (insts_left < LIMIT_STEP)
+	limit_step = insts_left;
+      insts_left -= limit_step;
+    }
+  if (time_limit > 0)
+    {
+      clock_gettime (CLOCK_MONOTONIC, &now);
+      if (now.tv_sec > deadline.tv_sec
+	  || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec))
+	{
+	  limit_hit = LIMIT_TIME;
+	  return TRUE;
+	}
+    }
+  return FALSE;
+}
+
+
 /* Get the current byte and advance the PC counter. */
 
 unsigned char
@@ -80,11 +197,20 @@ execute (void)
       signal (SIGINT, stop_execution);
     }
    
+  /* A profile tick until now was not in the program. */
+  if (profile_tick)
+    profile_enter ();
+
   had_sigint = FALSE;
   while (pc.pc_addr < functions[pc.pc_func].f_code_size
-	 && !runtime_error && !had_sigint)
+	 && !runtime_error && !had_sigint && !limit_hit && !bc_mem_exceeded)
     {
+      if (--limit_step == 0 && limit_check ())
+	break;
+      if (profile_tick)
+	profile_sample ();
       inst = byte(&pc);
+      STATS (stats_op (inst));
 
 #if DEBUG > 3
       { /* Print out address and the stack before each instruction.*/
@@ -155,7 +281,17 @@ execute (void)
 	/* Check to make sure it is defined. */
 	if (!functions[new_func].f_defined)
 	  {
-	    rt_error ("Function %s not defined.", f_names[new_func]);
+	    /* A builtin is used only if the user has not defined one. */
+	    if (builtin_available (new_func))
+	      {
+		STATS (stats_call (new_func));
+		TRACE (trace_begin (f_names[new_func]));
+		call_builtin (&pc, new_func);
+		TRACE (trace_end ());
+		STATS (stats_return (TRUE));
+	      }
+	    else
+	      rt_error ("Function %s not defined.", f_names[new_func]);
 	    break;
 	  }
 
@@ -176,6 +312,8 @@ execute (void)
 	/* Reset pc to start of function. */
 	pc.pc_func = new_func;
 	pc.pc_addr = 0;
+	STATS (stats_call (new_func));
+	TRACE (trace_begin (f_names[new_func]));
 	break;
 
       case 'D' : /* Duplicate top of stack */
@@ -236,7 +374,7 @@ execute (void)
 		  }
 	      }
 	  }
-	fflush (stdout);
+	if (interactive) BC_FLUSH (stdout);
 	break;
 
       case 'R' : /* Return from function */
@@ -249,6 +387,8 @@ execute (void)
 	    fpop ();
 	    pc.pc_addr = fpop ();
 	    pc.pc_func = fpop ();
+	    STATS (stats_return (FALSE));
+	    TRACE (trace_end ());
 	  }
 	else
 	  rt_error ("Return from main program.");
@@ -268,10 +408,10 @@ execute (void)
 
       case 'W' : /* Write the value on the top of the stack. */
       case 'P' : /* Write the value on the top of the stack.  No newline. */
-	bc_out_num (ex_stack->s_num, o_base, out_char, std_only);
+	out_num (ex_stack->s_num);
 	if (inst == 'W') out_char ('\n');
 	store_var (4);  /* Special variable "last". */
-	fflush (stdout);
+	if (interactive) BC_FLUSH (stdout);
 	pop ();
 	break;
 
@@ -294,8 +434,10 @@ execute (void)
 	  break;
 
 	case 'R':  /* Square Root function. */
+	  TRACE (trace_start ());
 	  if (!bc_sqrt (&ex_stack->s_num, scale))
 	    rt_error ("Square root of a negative number");
+	  TRACE (trace_op ("sqrt", ex_stack->s_num, NULL));
 	  break;
 
 	case 'I': /* Read function. */
@@ -352,7 +494,7 @@ execute (void)
 
       case 'w' : /* Write a string to the output. */
 	while ((ch = byte(&pc)) != '"') out_schar (ch);
-	fflush (stdout);
+	if (interactive) BC_FLUSH (stdout);
 	break;
 		   
       case 'x' : /* Exchange Top of Stack with the one under the tos. */
@@ -421,8 +563,11 @@ execute (void)
       case '*' : /* multiply */
 	if (check_stack(2))
 	  {
+	    TRACE (trace_start ());
 	    bc_multiply (ex_stack->s_next->s_num, ex_stack->s_num,
 			 &temp_num, scale);
+	    TRACE (trace_op ("multiply", ex_stack->s_next->s_num,
+			     ex_stack->s_num));
 	    pop();
 	    pop();
 	    push_num (temp_num);
@@ -433,9 +578,12 @@ execute (void)
       case '/' : /* divide */
 	if (check_stack(2))
 	  {
+	    TRACE (trace_start ());
 	    if (bc_divide (ex_stack->s_next->s_num,
 			   ex_stack->s_num, &temp_num, scale) == 0)
 	      {
+		TRACE (trace_op ("divide", ex_stack->s_next->s_num,
+				 ex_stack->s_num));
 		pop();
 		pop();
 		push_num (temp_num);
@@ -453,8 +601,11 @@ execute (void)
 	      rt_error ("Modulo by zero");
 	    else
 	      {
+		TRACE (trace_start ());
 		bc_modulo (ex_stack->s_next->s_num,
 			   ex_stack->s_num, &temp_num, scale);
+		TRACE (trace_op ("modulo", ex_stack->s_next->s_num,
+				 ex_stack->s_num));
 		pop();
 		pop();
 		push_num (temp_num);
@@ -466,8 +617,10 @@ execute (void)
       case '^' : /* raise */
 	if (check_stack(2))
 	  {
+	    TRACE (trace_start ());
 	    bc_raise (ex_stack->s_next->s_num,
 		      ex_stack->s_num, &temp_num, scale);
+	    TRACE (trace_op ("raise", temp_num, NULL));
 	    if (bc_is_zero (ex_stack->s_next->s_num) && bc_is_neg (ex_stack->s_num))
 	      rt_error ("divide by zero");
 	    pop();
@@ -542,6 +695,35 @@ execute (void)
       }
     }
 
+  STATS (stats_stop ());
+  TRACE (trace_stop ());
+
+  /* Stopped by a limit of the run.  The rest of the run is not
+     executed. */
+  if (limit_hit == LIMIT_TIME || limit_hit == LIMIT_INSTRUCTIONS)
+    {
+      if (limit_hit == LIMIT_TIME)
+	{
+	  rt_error ("Time limit exceeded");
+	  if (daemon_path != NULL)
+	    daemon_timeout ();
+	}
+      else
+	rt_error ("Instruction limit exceeded");
+      limit_hit = LIMIT_REPORTED;
+      limit_timer_off ();
+    }
+
+  /* Stopped by the memory limit.  The numbers made so far are freed
+     with the stack below. */
+  if (bc_mem_exceeded)
+    {
+      rt_error ("Memory limit of %lu bytes exceeded",
+		(unsigned long) bc_mem_limit);
+      bc_mem_exceeded = FALSE;
+      bc_cancel = FALSE;
+    }
+
   /* Clean up the function stack and pop all autos/parameters. */
   while (pc.pc_func != 0)
     {
@@ -575,6 +757,44 @@ prog_char (void)
 }
 
 
+/* The read function takes its input from a buffer filled with large
+   reads of the standard input rather than a call to getchar for each
+   character. */
+
+static char in_buffer[IN_BUFFER_SIZE];
+static int  in_next = 0;	/* The next character in in_buffer. */
+static int  in_count = 0;	/* The number of characters in in_buffer. */
+static char in_eof = FALSE;	/* The last read found end of file. */
+
+static int
+in_getc (void)
+{
+  if (in_next == in_count)
+    {
+      /* In batch mode the standard input holds only requests.  An
+	 embedded interpreter leaves it to the program it is in. */
+      if (batch_mode || exit_jump != NULL)
+	{
+	  in_eof = TRUE;
+	  return EOF;
+	}
+      in_next = 0;
+      BC_FLUSH (stdout);
+      while ((in_count = read (fileno (stdin), in_buffer, IN_BUFFER_SIZE)) < 0)
+	if (errno != EINTR)
+	  break;
+      if (in_count <= 0)
+	{
+	  in_count = 0;
+	  in_eof = TRUE;
+	  return EOF;
+	}
+      in_eof = FALSE;
+    }
+  return (unsigned char) in_buffer[in_next++];
+}
+
+
 /* Read a character from the standard input.  This function is used
    by the "read" function. */
 
@@ -584,14 +804,14 @@ input_char (void)
   int in_ch;
   
   /* Get a character from the standard input for the read function. */
-  in_ch = getchar();
+  in_ch = in_getc();
 
   /* Check for a \ quoted newline. */
   if (in_ch == '\\')
     {
-      in_ch = getchar();
+      in_ch = in_getc();
       if (in_ch == '\n') {
-	  in_ch = getchar();
+	  in_ch = in_getc();
 	  out_col = 0;  /* Saw a new line */
 	}
     }
@@ -616,32 +836,48 @@ input_char (void)
 
 /* Push_constant converts a sequence of input characters as returned
    by IN_CHAR into a number.  The number is pushed onto the execution
-   stack.  The number is converted as a number in base CONV_BASE. */
+   stack.  The number is converted as a number in base CONV_BASE.
+   The digits are gathered first and then converted all at once by
+   bc_digits2num, so a long constant takes one conversion rather than
+   a multiply and an add for each digit.  A digit of CONV_BASE or
+   more is taken as CONV_BASE-1, except for a lone integer digit. */
+
+static char *const_digits = NULL;	/* The digits of the number. */
+static int   const_size = 0;		/* The allocated size of const_digits. */
+
+static void
+const_digit (int len, int digit)
+{
+  if (len + 1 >= const_size)
+    {
+      const_digits = bc_realloc (const_digits, const_size,
+				 const_size == 0 ? 64 : const_size * 2);
+      const_size = (const_size == 0 ? 64 : const_size * 2);
+    }
+  const_digits[len] = "0123456789abcdefghijklmnopqrstuvwxyz"[digit];
+}
 
 void
 push_constant (int (*in_char)(VOID), int conv_base)
 {
-  int digits;
-  bc_num build, temp, result, mult, divisor;
-  int   in_ch, first_ch;
-  char  negative;
-
-  /* Initialize all bc numbers */
-  bc_init_num (&temp);
-  bc_init_num (&result);
-  bc_init_num (&mult);
-  build = bc_copy_num (_zero_);
-  negative = FALSE;
+  bc_num build;
+  int in_ch, first_ch, len, int_len;
+  char negative;
 
-  /* The conversion base. */
-  bc_int2num (&mult, conv_base);
-  
-  /* Get things ready. */
+  /* ~ is space returned by input_char(), prog_char does not return
+     spaces.  There is no number at the end of the input. */
   in_ch = in_char();
-  /* ~ is space returned by input_char(), prog_char does not return spaces. */
   while (in_ch == '~')
-    in_ch = in_char();
+    {
+      if (in_eof)
+	{
+	  rt_error ("End of file in read");
+	  return;
+	}
+      in_ch = in_char();
+    }
 
+  negative = FALSE;
   if (in_ch == '+')
     in_ch = in_char();
   else
@@ -652,55 +888,44 @@ push_constant (int (*in_char)(VOID), int conv_base)
       }
 
   /* Check for the special case of a single digit. */
+  len = 0;
   if (in_ch < 36)
     {
       first_ch = in_ch;
       in_ch = in_char();
       if (in_ch < 36 && first_ch >= conv_base)
 	first_ch = conv_base - 1;
-      bc_int2num (&build, (int) first_ch);
+      const_digit (len++, first_ch);
     }
 
-  /* Convert the integer part. */
+  /* The integer part. */
   while (in_ch < 36)
     {
-      if (in_ch < 36 && in_ch >= conv_base) in_ch = conv_base-1;
-      bc_multiply (build, mult, &result, 0);
-      bc_int2num (&temp, (int) in_ch);
-      bc_add (result, temp, &build, 0);
+      if (in_ch >= conv_base) in_ch = conv_base-1;
+      const_digit (len++, in_ch);
       in_ch = in_char();
     }
+  int_len = len;
+
+  /* The fraction.  Whatever follows the point is its first digit. */
   if (in_ch == '.')
     {
       in_ch = in_char();
       if (in_ch >= conv_base) in_ch = conv_base-1;
-      bc_free_num (&result);
-      bc_free_num (&temp);
-      divisor = bc_copy_num (_one_);
-      result = bc_copy_num (_zero_);
-      digits = 0;
       while (in_ch < 36)
 	{
-	  bc_multiply (result, mult, &result, 0);
-	  bc_int2num (&temp, (int) in_ch);
-	  bc_add (result, temp, &result, 0);
-	  bc_multiply (divisor, mult, &divisor, 0);
-	  digits++;
+	  const_digit (len++, in_ch);
 	  in_ch = in_char();
 	  if (in_ch < 36 && in_ch >= conv_base) in_ch = conv_base-1;
 	}
-      bc_divide (result, divisor, &result, digits);
-      bc_add (build, result, &build, 0);
     }
-  
-  /* Final work.  */
-  if (negative)
-    bc_sub (_zero_, build, &build, 0);
 
+  const_digit (len, 0);
+  const_digits[len] = '\0';
+  build = NULL;
+  bc_digits2num (&build, const_digits, int_len, len - int_len, conv_base,
+		 negative);
   push_num (build);
-  bc_free_num (&temp);
-  bc_free_num (&result);
-  bc_free_num (&mult);
 }
 
 
@@ -784,8 +1009,7 @@ push_b10_const (program_counter *progctr)
 	}
       inchar = byte(progctr);
     }
-  *ptr = '\0';
-  gmp_sscanf (nptr, "%Zd", build->n_value);
+  bc_set_decimal (build->n_value, nptr, ptr - nptr);
   free (nptr);
 
   push_num (build);
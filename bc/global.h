@@ -68,6 +68,66 @@ EXTERN int std_only  INIT(FALSE);
 /* Don't print the banner at start up.  -q flag. */
 EXTERN int quiet  INIT(FALSE);
 
+/* Read framed requests and write framed replies.  --batch flag. */
+EXTERN int batch_mode  INIT(FALSE);
+
+/* Serve batch requests on this Unix domain socket.  --daemon flag. */
+EXTERN char *daemon_path  INIT(NULL);
+
+/* The number of daemon worker processes.  --workers flag. */
+EXTERN int daemon_workers  INIT(4);
+
+/* The milliseconds allowed for a run: the program, each batch request
+   or each --map record.  0 for no limit.  --timeout flag. */
+EXTERN long time_limit  INIT(0);
+
+/* The instructions allowed for a run, 0 for no limit.
+   --max-instructions flag. */
+EXTERN unsigned long max_instructions  INIT(0);
+
+/* The program to run for each input record.  --map flag. */
+EXTERN char *map_expr  INIT(NULL);
+
+/* The variables for the fields of each record.  --fields flag. */
+EXTERN char *map_fields  INIT(NULL);
+
+/* The number of processes running records.  --jobs flag. */
+EXTERN int map_jobs  INIT(1);
+
+/* The scale of the mean and variance for --aggregate, or -1. */
+EXTERN int aggregate_scale  INIT(-1);
+
+/* The field totaled by --aggregate.  --column flag. */
+EXTERN int aggregate_column  INIT(1);
+
+/* Compute the math library functions with MPFR.  --float flag. */
+EXTERN int float_mode  INIT(FALSE);
+
+/* Write folded stacks of profile samples to this file.  --profile. */
+EXTERN char *profile_file  INIT(NULL);
+
+/* Write a timeline of calls and long operations to this file.  --trace. */
+EXTERN char *trace_file  INIT(NULL);
+
+/* Report counts and times at exit: 1 as text, 2 as JSON.  --stats. */
+EXTERN int stats_mode  INIT(0);
+
+#ifdef BC_STATS
+/* The bytes allocated, for --stats. */
+EXTERN unsigned long stats_bytes  INIT(0);
+#endif
+
+/* The --map program is being compiled. */
+EXTERN char map_compiling  INIT(FALSE);
+
+/* A limit of the run has been passed: LIMIT_TIME or LIMIT_INSTRUCTIONS
+   until it is reported, then LIMIT_REPORTED.  The rest of the run is
+   not executed. */
+EXTERN volatile int limit_hit;
+
+/* Set by the profile timer: take a sample at the next instruction. */
+EXTERN volatile int profile_tick;
+
 /* The list of file names to process. */
 EXTERN file_node *file_names  INIT(NULL);
 
@@ -137,6 +197,22 @@ EXTERN int line_size;
 EXTERN int line_no;
 EXTERN int had_error;
 
+/* The line of the last token, for the line tables of the code. */
+EXTERN int code_line;
+
+/* The number of errors reported, for the replies in batch mode. */
+EXTERN int error_count;
+
+/* Where output and messages are written.  These are stdout and stderr
+   except in an interpreter embedded with the bcapi.h interface. */
+EXTERN FILE *out_file;
+EXTERN FILE *err_file;
+
+/* In an embedded interpreter, bc_exit jumps here with the exit status
+   in exit_status rather than ending the process. */
+EXTERN jmp_buf *exit_jump  INIT(NULL);
+EXTERN int exit_status;
+
 /* For larger identifiers, a tree, and how many "storage" locations
    have been allocated. */
 
@@ -152,5 +228,8 @@ extern int optind;
 /* Access to the yy input file.  Defined in scan.c. */
 extern FILE *yyin;
 
+/* The function being compiled, or -1.  Defined in bc.y. */
+extern int cur_func;
+
 /* Access to libmath */
 extern CONST char *libmath[];
@@ -159,7 +159,7 @@ define s(x) {
   /* precondition x. */
   z = scale 
   scale = 1.1*z + 2;
-  v = a(1)
+  v = const(0)/4
   if (x < 0) {
     m = 1;
     x = -x;
@@ -199,7 +199,7 @@ define c(x) {
 
   z = scale;
   scale = scale*1.2;
-  v = s(x+a(1)*2);
+  v = s(x+const(0)/4*2);
   scale = z;
   return (v/1);
 }
@@ -285,52 +285,5 @@ define a(x) {
   }
 }
 
-
-/* Bessel function of integer order.  Uses the following:
-   j(-n,x) = (-1)^n*j(n,x) 
-   j(n,x) = x^n/(2^n*n!) * (1 - x^2/(2^2*1!*(n+1)) + x^4/(2^4*2!*(n+1)*(n+2))
-            - x^6/(2^6*3!*(n+1)*(n+2)*(n+3)) .... )
-*/
-define j(n,x) {
-  auto a, b, d, e, f, i, m, s, v, z
-
-  /* Non base 10 ibase? */
-  if (ibase != A) {
-     b = ibase;
-     ibase = A;
-     v = j(n,x);
-     ibase = b;
-     return (v);
-  }
-
-  /* Make n an integer and check for negative n. */
-  z = scale;
-  scale = 0;
-  n = n/1;
-  if (n<0) {
-    n = -n;
-    if (n%2 == 1) m = 1;
-  }
-
-  /* Compute the factor of x^n/(2^n*n!) */
-  f = 1;
-  for (i=2; i<=n; i++) f = f*i;
-  scale = 1.5*z;
-  f = x^n / 2^n / f;
-
-  /* Initialize the loop .*/
-  v = e = 1;
-  s = -x*x/4
-  scale = 1.5*z + length(f) - scale(f);
-
-  /* The Loop.... */
-  for (i=1; 1; i++) {
-    e =  e * s / i / (n+i);
-    if (e == 0) {
-       scale = z
-       if (m) return (-f*v/1);
-       return (f*v/1);
-    }
-    v += e;
-  }
-}
+/* The Bessel function of integer order, j(n,x), is a builtin.  See
+   builtin.c. */
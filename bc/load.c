@@ -36,6 +36,9 @@ program_counter load_adr;
 char load_str;
 char load_const;
 
+/* The math library has no source lines. */
+static char loading_mathlib = FALSE;
+
 /* Initialize the load sequence. */
 void
 init_load (void)
@@ -74,6 +77,49 @@ addbyte (unsigned char thebyte)
   /* Store the thebyte. */
   f->f_body[prog_addr] = (char) (thebyte & 0xff);
   f->f_code_size++;
+
+  /* Note the start of the code of a new line. */
+  if (!loading_mathlib
+      && (f->f_line_count == 0
+	  || f->f_lines[f->f_line_count-1].l_line != code_line))
+    {
+      if (f->f_line_count == f->f_line_size)
+	{
+	  f->f_lines = bc_realloc (f->f_lines,
+				   f->f_line_size * sizeof (bc_line_rec),
+				   (f->f_line_size + 16) * sizeof (bc_line_rec));
+	  f->f_line_size += 16;
+	}
+      if (f->f_line_count == 0)
+	f->f_file = is_std_in ? "(standard_in)" : file_name;
+      f->f_lines[f->f_line_count].l_addr = prog_addr;
+      f->f_lines[f->f_line_count].l_line = code_line;
+      f->f_line_count++;
+    }
+}
+
+
+/* The source line of the code of FUNC at ADDR, or 0 if it is not
+   known. */
+
+int
+code_line_of (int func, unsigned long addr)
+{
+  bc_function *f = &functions[func];
+  int low, high, mid;
+
+  /* The last entry at or before ADDR. */
+  low = 0;
+  high = f->f_line_count;
+  while (low < high)
+    {
+      mid = (low + high) / 2;
+      if (f->f_lines[mid].l_addr <= addr)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+  return low == 0 ? 0 : f->f_lines[low-1].l_line;
 }
 
 
@@ -218,7 +264,7 @@ load_code (const char *code)
 		label_no = long_val (&str);
 		if (label_no > 65535L)
 		  {  /* Better message? */
-		    fprintf (stderr,"Program too big.\n");
+		    fprintf (err_file,"Program too big.\n");
 		    bc_exit(1);
 		  }
 		addbyte ( (char) (label_no & 0xFF));
@@ -351,3 +397,43 @@ load_code (const char *code)
 	  }
     }
 }
+
+
+/* Load the code from a precompiled version of the math libarary. */
+
+void
+load_mathlib (void)
+{
+  CONST char **mstr;
+
+  /* These MUST be in the order of first mention of each function.
+     That is why "const" comes before "c", it is used in "s"!  The
+     builtins "const" and "j" are looked up here so that a user
+     definition of them gets a new number and does not change the
+     library. */
+  (void) lookup (strdup("e"), FUNCT);
+  (void) lookup (strdup("l"), FUNCT);
+  (void) lookup (strdup("s"), FUNCT);
+  (void) lookup (strdup("const"), FUNCT);
+  (void) lookup (strdup("c"), FUNCT);
+  (void) lookup (strdup("a"), FUNCT);
+  (void) lookup (strdup("j"), FUNCT);
+  mstr = libmath;
+  loading_mathlib = TRUE;
+  while (*mstr) {
+       load_code (*mstr);
+       mstr++;
+  }
+  loading_mathlib = FALSE;
+
+  /* With --float the builtins are used for e, l, s, c and a.  A
+     function that is not defined calls its builtin. */
+  if (float_mode)
+    {
+      functions[lookup (strdup("e"), FUNCT)].f_defined = FALSE;
+      functions[lookup (strdup("l"), FUNCT)].f_defined = FALSE;
+      functions[lookup (strdup("s"), FUNCT)].f_defined = FALSE;
+      functions[lookup (strdup("c"), FUNCT)].f_defined = FALSE;
+      functions[lookup (strdup("a"), FUNCT)].f_defined = FALSE;
+    }
+}
@@ -50,14 +50,29 @@ static char *el_pmtfunc(void) { return el_pmtchars; }
 /* long option support */
 static struct option long_options[] =
 {
+  {"aggregate",   1, 0,             'A'},
+  {"batch",       0, &batch_mode,   TRUE},
+  {"column",      1, 0,             'C'},
   {"compile",     0, &compile_only, TRUE},
+  {"daemon",      1, 0,             'D'},
   {"help",        0, 0,             'h'},
+  {"fields",      1, 0,             'F'},
+  {"float",       0, &float_mode,   TRUE},
   {"interactive", 0, 0,             'i'},
+  {"jobs",        1, 0,             'J'},
+  {"map",         1, 0,             'M'},
   {"mathlib",     0, &use_math,     TRUE},
+  {"max-instructions", 1, 0,        'I'},
+  {"max-memory",  1, 0,             'm'},
+  {"profile",     1, 0,             'P'},
   {"quiet",       0, &quiet,        TRUE},
   {"standard",    0, &std_only,     TRUE},
+  {"stats",       2, 0,             'S'},
+  {"timeout",     1, 0,             'T'},
+  {"trace",       1, 0,             'R'},
   {"version",     0, 0,             'v'},
   {"warn",        0, &warn_not_std, TRUE},
+  {"workers",     1, 0,             'W'},
 
   {0, 0, 0, 0}
 };
@@ -66,14 +81,49 @@ static struct option long_options[] =
 static void
 usage (const char *progname)
 {
-  printf ("usage: %s [options] [file ...]\n%s%s%s%s%s%s%s", progname,
-          "  -h  --help         print this usage and exit\n",
-	  "  -i  --interactive  force interactive mode\n",
-	  "  -l  --mathlib      use the predefined math routines\n",
-	  "  -q  --quiet        don't print initial banner\n",
-	  "  -s  --standard     non-standard bc constructs are errors\n",
-	  "  -w  --warn         warn about non-standard bc constructs\n",
-	  "  -v  --version      print version information and exit\n");
+  printf ("usage: %s [options] [file ...]\n%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s",
+	  progname,
+	  "  -h  --help                print this usage and exit\n",
+	  "  -i  --interactive         force interactive mode\n",
+	  "  -l  --mathlib             use the predefined math routines\n",
+	  "  -q  --quiet               don't print initial banner\n",
+	  "  -s  --standard            non-standard bc constructs are errors\n",
+	  "  -w  --warn                warn about non-standard bc constructs\n",
+	  "  -v  --version             print version information and exit\n",
+	  "      --batch               read framed programs, write framed results\n",
+	  "      --daemon=PATH         serve batch requests on the socket PATH\n",
+	  "      --workers=N           use N daemon worker processes\n",
+	  "      --timeout=SEC         stop a run after SEC seconds\n",
+	  "      --max-instructions=N  stop a run after N instructions\n",
+	  "      --map=PROGRAM         run PROGRAM for each line of input\n",
+	  "      --fields=LIST         store the fields of each line in the LIST names\n",
+	  "      --jobs=N              run the lines in N processes\n",
+	  "      --aggregate=SCALE     total a column of the input\n",
+	  "      --column=N            total column N for --aggregate\n",
+	  "      --float               compute e, l, s, c and a in binary floating point\n",
+	  "      --stats[=json]        report instruction counts and times at exit\n",
+	  "      --profile=FILE        sample the program, writing folded stacks to FILE\n",
+	  "      --trace=FILE          write a timeline of calls to FILE as trace events\n",
+	  "      --max-memory=SIZE     stop a run holding more than SIZE bytes of numbers\n");
+}
+
+
+/* A size in bytes, with an optional K, M or G.  0 if it is not one. */
+
+static size_t
+parse_size (const char *text)
+{
+  char *end;
+  unsigned long size;
+
+  size = strtoul (text, &end, 10);
+  switch (*end)
+    {
+    case 'k': case 'K': size <<= 10; end++; break;
+    case 'm': case 'M': size <<= 20; end++; break;
+    case 'g': case 'G': size <<= 30; end++; break;
+    }
+  return (*end == '\0' ? size : 0);
 }
 
 
@@ -134,6 +184,82 @@ parse_args (int argc, char **argv)
 	  warn_not_std = TRUE;
 	  break;
 
+	case 'A':  /* Total a column, with the mean at this scale. */
+	  aggregate_scale = atoi (optarg);
+	  if (aggregate_scale < 0)
+	    aggregate_scale = 0;
+	  break;
+
+	case 'C':  /* The column for --aggregate. */
+	  aggregate_column = atoi (optarg);
+	  if (aggregate_column < 1)
+	    aggregate_column = 1;
+	  break;
+
+	case 'D':  /* Serve requests on a socket. */
+	  daemon_path = optarg;
+	  batch_mode = TRUE;
+	  break;
+
+	case 'P':  /* Sample the program. */
+	  profile_file = optarg;
+	  break;
+
+	case 'R':  /* Record a timeline. */
+	  trace_file = optarg;
+	  break;
+
+	case 'S':  /* Report counts at exit. */
+	  if (optarg == NULL || strcmp (optarg, "text") == 0)
+	    stats_mode = 1;
+	  else if (strcmp (optarg, "json") == 0)
+	    stats_mode = 2;
+	  else
+	    {
+	      usage(argv[0]);
+	      bc_exit (1);
+	    }
+	  break;
+
+	case 'T':  /* Time limit for each run, in seconds. */
+	  time_limit = (long) (atof (optarg) * 1000);
+	  if (time_limit < 0)
+	    time_limit = 0;
+	  break;
+
+	case 'I':  /* Instructions allowed each run. */
+	  max_instructions = strtoul (optarg, NULL, 10);
+	  break;
+
+	case 'F':  /* Variables for the fields of a record. */
+	  map_fields = optarg;
+	  break;
+
+	case 'J':  /* Number of map processes. */
+	  map_jobs = atoi (optarg);
+	  if (map_jobs < 1)
+	    map_jobs = 1;
+	  break;
+
+	case 'm':  /* Limit the number storage. */
+	  bc_mem_limit = parse_size (optarg);
+	  if (bc_mem_limit == 0)
+	    {
+	      usage(argv[0]);
+	      bc_exit (1);
+	    }
+	  break;
+
+	case 'M':  /* Program to run for each record. */
+	  map_expr = optarg;
+	  break;
+
+	case 'W':  /* Number of daemon workers. */
+	  daemon_workers = atoi (optarg);
+	  if (daemon_workers < 1)
+	    daemon_workers = 1;
+	  break;
+
 	default:
 	  usage(argv[0]);
 	  bc_exit (1);
@@ -144,6 +270,31 @@ parse_args (int argc, char **argv)
   quiet = TRUE;
 #endif
 
+  if (stats_mode)
+    {
+#ifdef BC_STATS
+      stats_init ();
+#else
+      fprintf (stderr, "bc: this bc was built without --stats\n");
+      bc_exit (1);
+#endif
+    }
+
+  if (profile_file != NULL)
+    profile_start ();
+  TRACE (trace_init ());
+
+  /* The float functions replace those of the math library. */
+  if (float_mode)
+    {
+#ifdef HAVE_MPFR
+      use_math = TRUE;
+#else
+      fprintf (stderr, "bc: --float needs bc built with MPFR\n");
+      bc_exit (1);
+#endif
+    }
+
   /* Add file names to a list of files to process. */
   while (optind < argc)
     {
@@ -167,14 +318,13 @@ main (int argc, char **argv)
   char *env_argv[30];
   int   env_argc;
   
+  out_file = stdout;
+  err_file = stderr;
+
   /* Interactive? */
   if (isatty(0) && isatty(1)) 
     interactive = TRUE;
 
-#ifdef HAVE_SETVBUF
-  /* attempt to simplify interaction with applications such as emacs */
-  (void) setvbuf(stdout, NULL, _IOLBF, 0);
-#endif
 
   /* Environment arguments. */
   env_value = getenv ("BC_ENV_ARGS");
@@ -208,6 +358,21 @@ main (int argc, char **argv)
   if (getenv ("POSIXLY_CORRECT") != NULL)
     std_only = TRUE;
 
+  /* Batch, map and aggregate modes are never interactive. */
+  if (batch_mode || map_expr != NULL || aggregate_scale >= 0)
+    interactive = FALSE;
+
+#ifdef HAVE_SETVBUF
+  /* attempt to simplify interaction with applications such as emacs.
+     Otherwise the output is held in a large buffer.  It is flushed
+     before bc waits for more input, so a program talking to bc over
+     pipes still sees each answer. */
+  if (interactive)
+    (void) setvbuf(stdout, NULL, _IOLBF, 0);
+  else
+    (void) setvbuf(stdout, NULL, _IOFBF, OUT_BUFFER_SIZE);
+#endif
+
   env_value = getenv ("BC_LINE_LENGTH");
   if (env_value != NULL)
     {
@@ -216,7 +381,7 @@ main (int argc, char **argv)
 	line_size = 70;
     }
   else
-    line_size = 70;
+    line_size = (map_expr != NULL || aggregate_scale >= 0 ? 0 : 70);
 
   /* Initialize the machine.  */
   init_storage();
@@ -256,8 +421,13 @@ main (int argc, char **argv)
   }
 #endif
 
-  /* Do the parse. */
+  /* Do the parse.  The files and the standard input are one run.
+     In batch mode each request after the first gets a parse of its
+     own. */
+  limit_start ();
   yyparse ();
+  while (batch_mode && batch_next ())
+    yyparse ();
 
   /* End the compile only output with a newline. */
   if (compile_only)
@@ -281,30 +451,12 @@ open_new_file (void)
   /* Set the line number. */
   line_no = 1;
 
-  /* Check to see if we are done. */
-  if (is_std_in) return (FALSE);
+  /* Check to see if we are done.  Nothing follows the --map program. */
+  if (is_std_in || map_compiling) return (FALSE);
 
   /* Open the other files. */
   if (use_math && first_file)
-    {
-      /* Load the code from a precompiled version of the math libarary. */
-      CONST char **mstr;
-
-      /* These MUST be in the order of first mention of each function.
-	 That is why "a" comes before "c" even though "a" is defined after
-	 after "c".  "a" is used in "s"! */
-      (void) lookup (strdup("e"), FUNCT);
-      (void) lookup (strdup("l"), FUNCT);
-      (void) lookup (strdup("s"), FUNCT);
-      (void) lookup (strdup("a"), FUNCT);
-      (void) lookup (strdup("c"), FUNCT);
-      (void) lookup (strdup("j"), FUNCT);
-      mstr = libmath;
-      while (*mstr) {
-           load_code (*mstr);
-	   mstr++;
-      }
-    }
+    load_mathlib ();
   
   /* One of the argv values. */
   if (file_names != NULL)
@@ -323,6 +475,20 @@ open_new_file (void)
       bc_exit (1);
     }
   
+  /* Batch requests and --map records are runs of their own. */
+  if (batch_mode || map_expr != NULL)
+    limit_stop ();
+
+  /* The standard input holds the records for --map or --aggregate. */
+  if (aggregate_scale >= 0)
+    aggregate_run ();
+  if (map_expr != NULL)
+    map_run ();
+
+  /* A daemon worker takes its requests from a client. */
+  if (daemon_path != NULL)
+    daemon_start ();
+
   /* If we fall through to here, we should return stdin. */
   new_yy_file (stdin);
   is_std_in = TRUE;
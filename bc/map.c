@@ -0,0 +1,818 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* map.c - run a program for each record of the input, for --map, and
+   total a column of the input, for --aggregate. */
+
+#include "bcdefs.h"
+#include <errno.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include "proto.h"
+
+/* From scan.c. */
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+YY_BUFFER_STATE yy_scan_bytes (const char *bytes, int len);
+
+/* With --map, bc runs the files named on the command line and then
+   compiles the --map program once.  Its code is kept in the main
+   function rather than being run and thrown away as usual.  Each line
+   of the standard input is a record of fields separated by commas or
+   tabs.  The fields are stored in the variables named by --fields, in
+   order, and the kept code is run.  An empty name skips a field.
+
+   With --jobs, the input is cut into chunks of whole records.  Each
+   chunk is run by a child process into a temporary file and the files
+   are copied to the output in the order of the chunks.  Each child
+   starts from the state after the files, so a variable carried from
+   one record to the next only sees the records of its chunk.
+
+   With --aggregate, no program is run.  The numbers in one field of
+   each record are totaled exactly, with mpz_t values held at the
+   largest scale seen so far, and the count, sum, minimum, maximum,
+   mean and variance are printed.  A regular file as the standard input
+   is mapped into memory rather than read.  With --jobs, each block of
+   the input is split among that many threads and their totals are
+   added together. */
+
+/* The size of the chunks read from the input. */
+#define MAP_CHUNK (16 * IN_BUFFER_SIZE)
+
+/* Fields have at most this many digits. */
+#define MAP_FIELD_MAX 4096
+
+static int   *field_vars;	/* The variable for each field, or 0. */
+static int    field_count;
+static long   record_no;	/* The number of the current record. */
+
+static char  *map_buf;		/* The input not yet run. */
+static long   map_size;		/* The size of map_buf. */
+static long   map_start;	/* The first byte not yet run. */
+static long   map_end;		/* The end of the bytes read. */
+static char   map_eof = FALSE;
+
+/* The children running chunks, oldest first, for --jobs. */
+typedef struct {
+      pid_t  j_pid;
+      FILE  *j_out;
+    } map_job;
+static map_job *jobs;
+static int      job_count = 0;
+
+
+/* Set up field_vars from the --fields list. */
+
+static void
+map_fields_init (void)
+{
+  char *list, *name, *next;
+  int ix;
+
+  field_count = 1;
+  for (list = map_fields; list != NULL && *list != '\0'; list++)
+    if (*list == ',')
+      field_count++;
+  field_vars = bc_malloc (field_count * sizeof (int));
+
+  list = strcopyof (map_fields != NULL ? map_fields : "");
+  for (ix = 0, name = list; ix < field_count; ix++, name = next)
+    {
+      next = strchr (name, ',');
+      if (next != NULL)
+	*next++ = '\0';
+      field_vars[ix] = 0;
+      if (*name == '\0')
+	continue;
+      if (!islower ((int) *name) || name[strspn (name,
+	    "abcdefghijklmnopqrstuvwxyz0123456789_")] != '\0')
+	{
+	  fprintf (stderr, "bc: bad field name %s\n", name);
+	  bc_exit (1);
+	}
+      field_vars[ix] = lookup (strcopyof (name), SIMPLE);
+    }
+  free (list);
+}
+
+
+/* Compile the --map program into the main function. */
+
+static void
+map_compile (void)
+{
+  char *text;
+  int len, errors;
+
+  len = strlen (map_expr);
+  text = bc_malloc (len + 2);
+  strcpy (text, map_expr);
+  text[len++] = '\n';
+  text[len] = '\0';
+
+  errors = error_count;
+  is_std_in = FALSE;
+  file_name = "(map)";
+  line_no = 1;
+  init_gen ();
+  map_compiling = TRUE;
+  yy_scan_bytes (text, len);
+  yyparse ();
+  map_compiling = FALSE;
+  free (text);
+
+  if (error_count != errors || had_error)
+    bc_exit (1);
+}
+
+
+/* Convert the field of LEN bytes at STR to NUM.  A field is an
+   optional sign and a decimal number, with spaces around it.  Returns
+   FALSE if it is not a number. */
+
+static int
+map_number (bc_num *num, const char *str, int len)
+{
+  char digits[MAP_FIELD_MAX+1];
+  const char *end = str + len;
+  int int_len, frac_len, negative;
+
+  while (str < end && (*str == ' ' || *str == '\r'))
+    str++;
+  while (end > str && (end[-1] == ' ' || end[-1] == '\r'))
+    end--;
+
+  negative = FALSE;
+  if (str < end && (*str == '-' || *str == '+'))
+    negative = (*str++ == '-');
+  while (str < end - 1 && *str == '0' && str[1] != '.')
+    str++;
+
+  int_len = 0;
+  while (str < end && isdigit ((int) *str) && int_len < MAP_FIELD_MAX)
+    digits[int_len++] = *str++;
+  frac_len = 0;
+  if (str < end && *str == '.')
+    for (str++; str < end && isdigit ((int) *str)
+		&& int_len + frac_len < MAP_FIELD_MAX; str++)
+      digits[int_len + frac_len++] = *str;
+  digits[int_len + frac_len] = '\0';
+
+  if (str != end || int_len + frac_len == 0)
+    return FALSE;
+  bc_digits2num (num, digits, int_len, frac_len, 10, negative);
+  return TRUE;
+}
+
+
+/* Run the kept code for the record of LEN bytes at LINE. */
+
+static void
+map_record (const char *line, long len)
+{
+  const char *end = line + len;
+  const char *field;
+  bc_var *var;
+  bc_num num;
+  int ix;
+
+  record_no++;
+  if (len == 0)
+    return;
+  bc_init_num (&num);
+  field = line;
+  for (ix = 0; ix < field_count; ix++)
+    {
+      for (line = field; line < end && *line != ',' && *line != '\t'; line++)
+	;
+      if (field_vars[ix] != 0)
+	{
+	  if (field == end && ix > 0)
+	    {
+	      fprintf (stderr, "bc: record %ld has only %d fields\n",
+		       record_no, ix);
+	      error_count++;
+	      return;
+	    }
+	  if (!map_number (&num, field, line - field))
+	    {
+	      fprintf (stderr, "bc: field %d of record %ld is not a number\n",
+		       ix + 1, record_no);
+	      error_count++;
+	      return;
+	    }
+	  var = get_var (field_vars[ix]);
+	  bc_free_num (&var->v_value);
+	  var->v_value = num;
+	  bc_init_num (&num);
+	}
+      field = (line < end ? line + 1 : end);
+    }
+
+  out_col = 0;
+  limit_start ();
+  execute ();
+  limit_stop ();
+}
+
+
+/* Read more of the standard input into map_buf, keeping the bytes from
+   map_start.  Returns FALSE at end of file. */
+
+static int
+map_fill (void)
+{
+  long count;
+
+  if (map_start > 0)
+    {
+      memmove (map_buf, map_buf + map_start, map_end - map_start);
+      map_end -= map_start;
+      map_start = 0;
+    }
+  if (map_end == map_size)
+    {
+      map_buf = bc_realloc (map_buf, map_size, 2 * map_size);
+      map_size *= 2;
+    }
+
+  fflush (stdout);
+  while ((count = read (0, map_buf + map_end, map_size - map_end)) < 0)
+    if (errno != EINTR)
+      break;
+  if (count <= 0)
+    {
+      map_eof = TRUE;
+      return FALSE;
+    }
+  map_end += count;
+  return TRUE;
+}
+
+
+/* The end of the whole records in map_buf.  At end of file the last
+   record need not end with a newline. */
+
+static long
+map_limit (void)
+{
+  char *nl;
+
+  if (map_eof)
+    return map_end;
+  nl = map_buf + map_end;
+  while (nl > map_buf + map_start && nl[-1] != '\n')
+    nl--;
+  return nl - map_buf;
+}
+
+
+/* Run the records from map_start up to LIMIT, which ends a record. */
+
+static void
+map_records (long limit)
+{
+  char *line, *nl;
+
+  while (map_start < limit)
+    {
+      line = map_buf + map_start;
+      nl = memchr (line, '\n', limit - map_start);
+      if (nl == NULL)
+	nl = map_buf + limit;
+      map_record (line, nl - line);
+      map_start = nl - map_buf + 1;
+    }
+  if (map_start > limit)
+    map_start = limit;
+}
+
+
+/* Copy the output of the oldest job to the standard output. */
+
+static void
+job_finish (void)
+{
+  char buf[IN_BUFFER_SIZE];
+  int status;
+  ssize_t len;
+
+  while (waitpid (jobs[0].j_pid, &status, 0) < 0 && errno == EINTR)
+    ;
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    error_count++;
+
+  fflush (stdout);
+  lseek (fileno (jobs[0].j_out), 0, SEEK_SET);
+  while ((len = read (fileno (jobs[0].j_out), buf, sizeof (buf))) > 0)
+    if (fwrite (buf, 1, len, stdout) != (size_t) len)
+      break;
+  fclose (jobs[0].j_out);
+
+  job_count--;
+  memmove (jobs, jobs + 1, job_count * sizeof (map_job));
+}
+
+
+/* Run the records up to LIMIT in a child process. */
+
+static void
+job_start (long limit)
+{
+  char *nl;
+  FILE *out;
+  pid_t pid;
+  long records;
+
+  if (job_count == map_jobs)
+    job_finish ();
+
+  fflush (stdout);
+  out = tmpfile ();
+  if (out == NULL)
+    {
+      perror ("bc: map");
+      bc_exit (1);
+    }
+  pid = fork ();
+  if (pid < 0)
+    {
+      perror ("bc: fork");
+      bc_exit (1);
+    }
+  if (pid == 0)
+    {
+      if (dup2 (fileno (out), 1) < 0)
+	_exit (1);
+      map_records (limit);
+      fflush (stdout);
+      _exit (error_count != 0);
+    }
+  jobs[job_count].j_pid = pid;
+  jobs[job_count].j_out = out;
+  job_count++;
+
+  /* Keep the record numbers the child used. */
+  records = 0;
+  for (nl = map_buf + map_start;
+       (nl = memchr (nl, '\n', map_buf + limit - nl)) != NULL; nl++)
+    records++;
+  if (limit > map_start && map_buf[limit-1] != '\n')
+    records++;
+  record_no += records;
+  map_start = limit;
+}
+
+
+/* Run the --map program for each record of the standard input. */
+
+void
+map_run (void)
+{
+  long limit;
+
+  map_fields_init ();
+  map_compile ();
+
+  map_size = MAP_CHUNK;
+  map_buf = bc_malloc (map_size);
+  map_start = map_end = 0;
+  if (map_jobs > 1)
+    jobs = bc_malloc (map_jobs * sizeof (map_job));
+
+  while (map_fill () || map_start < map_end)
+    {
+      limit = map_limit ();
+      if (map_jobs > 1)
+	{
+	  if (limit > map_start && (map_eof || limit - map_start >= MAP_CHUNK / 2))
+	    job_start (limit);
+	}
+      else
+	map_records (limit);
+      if (map_eof)
+	break;
+    }
+
+  while (job_count > 0)
+    job_finish ();
+  bc_exit (error_count != 0);
+}
+
+
+/* The totals for --aggregate.  Each thread has one for its part of a
+   block, and they are added into one for the whole input.  The sum,
+   minimum and maximum are at a_scale and the sum of squares is at twice
+   that. */
+
+typedef struct {
+      const char *a_text;	/* The part of the input to total. */
+      long   a_len;
+      long   a_lines;		/* The lines seen. */
+      long   a_count;		/* The numbers totaled. */
+      int    a_scale;
+      mpz_t  a_sum;
+      mpz_t  a_squares;
+      mpz_t  a_min;
+      mpz_t  a_max;
+      mpz_t  a_value;		/* The number being added. */
+      long  *a_bad;		/* The lines without a number. */
+      int    a_nbad;
+      int    a_badsize;
+    } agg_total;
+
+/* The digits that fit an unsigned long. */
+#define AGG_FAST_DIGITS (ULONG_MAX > 0xffffffffUL ? 19 : 9)
+
+static void
+agg_init (agg_total *total)
+{
+  memset (total, 0, sizeof (agg_total));
+  mpz_init (total->a_sum);
+  mpz_init (total->a_squares);
+  mpz_init (total->a_min);
+  mpz_init (total->a_max);
+  mpz_init (total->a_value);
+}
+
+static void
+agg_clear (agg_total *total)
+{
+  mpz_clear (total->a_sum);
+  mpz_clear (total->a_squares);
+  mpz_clear (total->a_min);
+  mpz_clear (total->a_max);
+  mpz_clear (total->a_value);
+  if (total->a_bad != NULL)
+    free (total->a_bad);
+}
+
+
+/* Multiply VALUE by 10^DIGITS. */
+
+static void
+agg_shift (mpz_t value, int digits)
+{
+  unsigned long power;
+  int ix;
+
+  while (digits > 0)
+    {
+      for (power = 1, ix = 0; ix < digits && ix < AGG_FAST_DIGITS; ix++)
+	power *= 10;
+      mpz_mul_ui (value, value, power);
+      digits -= ix;
+    }
+}
+
+
+/* Move TOTAL to SCALE, which is larger than its scale. */
+
+static void
+agg_rescale (agg_total *total, int scale)
+{
+  int digits = scale - total->a_scale;
+
+  agg_shift (total->a_sum, digits);
+  agg_shift (total->a_min, digits);
+  agg_shift (total->a_max, digits);
+  agg_shift (total->a_squares, 2 * digits);
+  total->a_scale = scale;
+}
+
+
+/* Read the decimal number from STR to END into a_value.  Returns its
+   scale, or -1 if it is not a number.  Up to AGG_FAST_DIGITS digits are
+   converted in a register. */
+
+static int
+agg_number (agg_total *total, const char *str, const char *end)
+{
+  char digits[MAP_FIELD_MAX+1];
+  const char *start;
+  unsigned long value;
+  int ndigits, scale, negative, point;
+
+  while (str < end && (*str == ' ' || *str == '\r'))
+    str++;
+  while (end > str && (end[-1] == ' ' || end[-1] == '\r'))
+    end--;
+  negative = FALSE;
+  if (str < end && (*str == '-' || *str == '+'))
+    negative = (*str++ == '-');
+
+  start = str;
+  value = 0;
+  ndigits = scale = 0;
+  point = FALSE;
+  for (; str < end; str++)
+    if ((unsigned) (*str - '0') < 10)
+      {
+	value = value * 10 + (*str - '0');
+	ndigits++;
+	scale += point;
+      }
+    else if (*str == '.' && !point)
+      point = TRUE;
+    else
+      return -1;
+  if (ndigits == 0)
+    return -1;
+
+  if (ndigits <= AGG_FAST_DIGITS)
+    mpz_set_ui (total->a_value, value);
+  else
+    {
+      if (ndigits > MAP_FIELD_MAX)
+	return -1;
+      for (ndigits = 0; start < end; start++)
+	if (*start != '.')
+	  digits[ndigits++] = *start;
+      bc_set_decimal (total->a_value, digits, ndigits);
+    }
+  if (negative)
+    mpz_neg (total->a_value, total->a_value);
+  return scale;
+}
+
+
+/* Add a_value, at SCALE, to TOTAL. */
+
+static void
+agg_add (agg_total *total, int scale)
+{
+  if (scale > total->a_scale)
+    agg_rescale (total, scale);
+  else
+    agg_shift (total->a_value, total->a_scale - scale);
+
+  mpz_add (total->a_sum, total->a_sum, total->a_value);
+  mpz_addmul (total->a_squares, total->a_value, total->a_value);
+  if (total->a_count == 0 || mpz_cmp (total->a_value, total->a_min) < 0)
+    mpz_set (total->a_min, total->a_value);
+  if (total->a_count == 0 || mpz_cmp (total->a_value, total->a_max) > 0)
+    mpz_set (total->a_max, total->a_value);
+  total->a_count++;
+}
+
+
+/* Total the lines of a_text.  This runs in a thread of its own. */
+
+static void *
+agg_part (void *arg)
+{
+  agg_total *total = arg;
+  const char *line = total->a_text;
+  const char *end = line + total->a_len;
+  const char *eol, *field, *fend;
+  int ix, scale;
+
+  TRACE (trace_begin ("aggregate"));
+  for (; line < end; line = eol + 1)
+    {
+      eol = memchr (line, '\n', end - line);
+      if (eol == NULL)
+	eol = end;
+      total->a_lines++;
+      if (eol == line)
+	continue;
+
+      /* Find the field. */
+      field = line;
+      for (ix = 1; ix < aggregate_column && field <= eol; ix++)
+	{
+	  while (field < eol && *field != ',' && *field != '\t')
+	    field++;
+	  field++;
+	}
+      scale = -1;
+      if (field <= eol)
+	{
+	  for (fend = field; fend < eol && *fend != ',' && *fend != '\t'; fend++)
+	    ;
+	  scale = agg_number (total, field, fend);
+	}
+
+      if (scale >= 0)
+	agg_add (total, scale);
+      else
+	{
+	  if (total->a_nbad == total->a_badsize)
+	    {
+	      total->a_badsize = 2 * total->a_badsize + 16;
+	      total->a_bad = bc_realloc (total->a_bad,
+					 total->a_nbad * sizeof (long),
+					 total->a_badsize * sizeof (long));
+	    }
+	  total->a_bad[total->a_nbad++] = total->a_lines;
+	}
+    }
+  TRACE (trace_end ());
+  return NULL;
+}
+
+
+/* Add PART, which follows the lines already in TOTAL, to TOTAL. */
+
+static void
+agg_merge (agg_total *total, agg_total *part)
+{
+  int ix;
+
+  for (ix = 0; ix < part->a_nbad; ix++)
+    {
+      fprintf (stderr, "bc: line %ld has no number in field %d\n",
+	       total->a_lines + part->a_bad[ix], aggregate_column);
+      error_count++;
+    }
+  total->a_lines += part->a_lines;
+  if (part->a_count == 0)
+    return;
+
+  if (part->a_scale > total->a_scale)
+    agg_rescale (total, part->a_scale);
+  else if (part->a_scale < total->a_scale)
+    agg_rescale (part, total->a_scale);
+  mpz_add (total->a_sum, total->a_sum, part->a_sum);
+  mpz_add (total->a_squares, total->a_squares, part->a_squares);
+  if (total->a_count == 0 || mpz_cmp (part->a_min, total->a_min) < 0)
+    mpz_set (total->a_min, part->a_min);
+  if (total->a_count == 0 || mpz_cmp (part->a_max, total->a_max) > 0)
+    mpz_set (total->a_max, part->a_max);
+  total->a_count += part->a_count;
+}
+
+
+/* Total the LEN bytes of whole lines at TEXT into TOTAL. */
+
+static void
+agg_block (agg_total *total, const char *text, long len)
+{
+  agg_total *parts;
+  pthread_t *threads;
+  const char *start, *split;
+  int count, ix;
+
+  /* Small blocks are not worth a thread. */
+  count = map_jobs;
+  if (len < count * (long) IN_BUFFER_SIZE)
+    count = 1;
+
+  parts = bc_malloc (count * sizeof (agg_total));
+  threads = bc_malloc (count * sizeof (pthread_t));
+  start = text;
+  for (ix = 0; ix < count; ix++)
+    {
+      agg_init (&parts[ix]);
+      split = (ix == count - 1 ? text + len : text + len / count * (ix + 1));
+      if (split < start)
+	split = start;
+      while (split < text + len && split[-1] != '\n')
+	split++;
+      parts[ix].a_text = start;
+      parts[ix].a_len = split - start;
+      start = split;
+    }
+
+  if (count == 1)
+    agg_part (&parts[0]);
+  else
+    {
+      for (ix = 0; ix < count; ix++)
+	if (pthread_create (&threads[ix], NULL, agg_part, &parts[ix]) != 0)
+	  {
+	    perror ("bc: thread");
+	    bc_exit (1);
+	  }
+      for (ix = 0; ix < count; ix++)
+	pthread_join (threads[ix], NULL);
+    }
+
+  for (ix = 0; ix < count; ix++)
+    {
+      agg_merge (total, &parts[ix]);
+      agg_clear (&parts[ix]);
+    }
+  free (parts);
+  free (threads);
+}
+
+
+/* Print NAME and VALUE at SCALE on a line. */
+
+static void
+agg_print (const char *name, mpz_t value, int scale)
+{
+  bc_num num;
+
+  num = bc_new_num (1, scale);
+  mpz_set (num->n_value, value);
+  fprintf (out_file, "%s ", name);
+  out_num (num);
+  out_char ('\n');
+  bc_free_num (&num);
+}
+
+
+/* Total the standard input for --aggregate. */
+
+void
+aggregate_run (void)
+{
+  agg_total total;
+  struct stat st;
+  void *mapped;
+  bc_num sum, squares, count, mean, variance, temp;
+  mpz_t number;
+  long limit;
+
+  agg_init (&total);
+  mapped = MAP_FAILED;
+  if (fstat (0, &st) == 0 && S_ISREG (st.st_mode) && st.st_size > 0)
+    mapped = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, 0, 0);
+
+  if (mapped != MAP_FAILED)
+    {
+      agg_block (&total, mapped, st.st_size);
+      munmap (mapped, st.st_size);
+    }
+  else
+    {
+      map_size = MAP_CHUNK;
+      map_buf = bc_malloc (map_size);
+      map_start = map_end = 0;
+      while (map_fill () || map_start < map_end)
+	{
+	  limit = map_limit ();
+	  agg_block (&total, map_buf + map_start, limit - map_start);
+	  map_start = limit;
+	  if (map_eof)
+	    break;
+	}
+    }
+
+  mpz_init_set_si (number, total.a_count);
+  agg_print ("count", number, 0);
+  if (total.a_count > 0)
+    {
+      agg_print ("sum", total.a_sum, total.a_scale);
+      agg_print ("min", total.a_min, total.a_scale);
+      agg_print ("max", total.a_max, total.a_scale);
+
+      /* The mean is sum/n.  The variance is of a sample,
+	 (n*squares - sum^2) / (n*(n-1)). */
+      sum = bc_new_num (1, total.a_scale);
+      mpz_set (sum->n_value, total.a_sum);
+      squares = bc_new_num (1, 2 * total.a_scale);
+      mpz_set (squares->n_value, total.a_squares);
+      count = bc_new_num (1, 0);
+      mpz_set (count->n_value, number);
+      bc_init_num (&mean);
+      bc_init_num (&variance);
+      bc_init_num (&temp);
+      bc_divide (sum, count, &mean, aggregate_scale);
+      agg_print ("mean", mean->n_value, mean->n_scale);
+      if (total.a_count > 1)
+	{
+	  bc_multiply (squares, count, &variance, 2 * total.a_scale);
+	  bc_multiply (sum, sum, &temp, 2 * total.a_scale);
+	  bc_sub (variance, temp, &variance, 0);
+	  mpz_mul_si (count->n_value, count->n_value, total.a_count - 1);
+	  bc_divide (variance, count, &variance, aggregate_scale);
+	  agg_print ("variance", variance->n_value, variance->n_scale);
+	}
+      bc_free_num (&sum);
+      bc_free_num (&squares);
+      bc_free_num (&count);
+      bc_free_num (&mean);
+      bc_free_num (&variance);
+      bc_free_num (&temp);
+    }
+  mpz_clear (number);
+  agg_clear (&total);
+  bc_exit (error_count != 0);
+}
@@ -0,0 +1,322 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* profile.c - a sampling profiler for bc programs, for --profile. */
+
+#include "bcdefs.h"
+#include "proto.h"
+#include <signal.h>
+#include <sys/time.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+/* A timer on the CPU time of the process sets profile_tick, and
+   execute takes a sample before its next instruction: the program
+   counter and the return addresses on the function stack, each
+   mapped to a source line by the line table of its function.  The
+   samples are counted two ways: by the stack of function names, for
+   the folded stack file that flame graph tools read, and by source
+   line, for the report at exit.  A tick while bc is not running code
+   is counted as "(compile)". */
+
+/* The asked for rate; the system may deliver fewer. */
+#define PROFILE_HZ 1000
+
+/* A counted stack or line. */
+typedef struct prof_rec {
+      char *p_key;
+      unsigned long p_self;	/* Samples at the top of the stack. */
+      unsigned long p_total;	/* Samples anywhere in the stack. */
+      unsigned long p_last;	/* The sample last counted in p_total. */
+      struct prof_rec *p_next;
+    } prof_rec;
+
+#define PROF_BUCKETS 1024
+
+static prof_rec *stacks[PROF_BUCKETS];
+static prof_rec *lines[PROF_BUCKETS];
+static unsigned long samples = 0;
+
+/* The process that reports, so that children do not. */
+static pid_t profile_pid;
+
+/* Space for keys. */
+static char *key_buf = NULL;
+static size_t key_size = 0;
+
+
+/* The timer signal. */
+
+static void
+profile_timer (int sig)
+{
+  profile_tick = TRUE;
+}
+
+
+/* Start the timer. */
+
+void
+profile_start (void)
+{
+  struct sigaction act;
+  struct itimerval timer;
+
+  profile_pid = getpid ();
+  memset (&act, 0, sizeof (act));
+  act.sa_handler = profile_timer;
+  act.sa_flags = SA_RESTART;
+  sigemptyset (&act.sa_mask);
+  sigaction (SIGPROF, &act, NULL);
+
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = 1000000 / PROFILE_HZ;
+  timer.it_value = timer.it_interval;
+  setitimer (ITIMER_PROF, &timer, NULL);
+}
+
+
+/* The record for KEY in TABLE, made if new. */
+
+static prof_rec *
+find_rec (prof_rec **table, const char *key)
+{
+  unsigned long hash;
+  const char *ch;
+  prof_rec *rec;
+
+  for (hash = 0, ch = key; *ch != '\0'; ch++)
+    hash = hash * 31 + (unsigned char) *ch;
+  hash %= PROF_BUCKETS;
+  for (rec = table[hash]; rec != NULL; rec = rec->p_next)
+    if (strcmp (rec->p_key, key) == 0)
+      return rec;
+  rec = bc_malloc (sizeof (prof_rec));
+  rec->p_key = strcopyof (key);
+  rec->p_self = rec->p_total = rec->p_last = 0;
+  rec->p_next = table[hash];
+  table[hash] = rec;
+  return rec;
+}
+
+/* Make room for LEN more characters of key after USED. */
+
+static void
+key_room (size_t used, size_t len)
+{
+  if (used + len + 1 > key_size)
+    {
+      key_buf = bc_realloc (key_buf, key_size, 2 * (used + len + 1));
+      key_size = 2 * (used + len + 1);
+    }
+}
+
+/* Count one sample of the source line of FUNC at ADDR.  TOP is TRUE
+   for the top of the stack. */
+
+static void
+count_line (int func, unsigned long addr, int top)
+{
+  char line[200];
+  prof_rec *rec;
+  const char *file;
+  int line_no;
+
+  line_no = code_line_of (func, addr);
+  file = functions[func].f_file;
+  if (line_no == 0 || file == NULL)
+    snprintf (line, sizeof (line), "(%s)", f_names[func]);
+  else if (func == 0)
+    snprintf (line, sizeof (line), "%.150s:%d", file, line_no);
+  else
+    snprintf (line, sizeof (line), "%.150s:%d (%.30s)",
+	      file, line_no, f_names[func]);
+  rec = find_rec (lines, line);
+  if (top)
+    rec->p_self++;
+  if (rec->p_last != samples)
+    {
+      rec->p_total++;
+      rec->p_last = samples;
+    }
+}
+
+/* Count one sample of the stack of the COUNT functions in FUNCS,
+   the innermost first. */
+
+static void
+count_stack (int count, int *funcs)
+{
+  size_t used, len;
+  int ix;
+
+  /* The outermost function first, separated by ';'. */
+  used = 0;
+  for (ix = count-1; ix >= 0; ix--)
+    {
+      len = strlen (f_names[funcs[ix]]);
+      key_room (used, len + 1);
+      memcpy (key_buf + used, f_names[funcs[ix]], len);
+      used += len;
+      key_buf[used++] = (ix > 0 ? ';' : '\0');
+    }
+  find_rec (stacks, key_buf)->p_self++;
+}
+
+
+/* Take a sample of the running program. */
+
+void
+profile_sample (void)
+{
+  static int *funcs = NULL;
+  static int funcs_size = 0;
+  fstack_rec *frame;
+  unsigned long addr;
+  int count, func;
+
+  profile_tick = FALSE;
+  samples++;
+
+  /* The function running, then each caller.  The function stack has
+     the ibase, return address and function of each call. */
+  count = 0;
+  func = pc.pc_func;
+  addr = pc.pc_addr;
+  frame = fn_stack;
+  for (;;)
+    {
+      if (count == funcs_size)
+	{
+	  funcs = bc_realloc (funcs, funcs_size * sizeof (int),
+			      (funcs_size + 32) * sizeof (int));
+	  funcs_size += 32;
+	}
+      funcs[count] = func;
+      count_line (func, addr, count == 0);
+      count++;
+      if (func == 0 || frame == NULL || frame->s_next == NULL
+	  || frame->s_next->s_next == NULL)
+	break;
+      /* A return address is just after its call. */
+      addr = frame->s_next->s_val - 1;
+      func = frame->s_next->s_next->s_val;
+      frame = frame->s_next->s_next->s_next;
+    }
+  count_stack (count, funcs);
+}
+
+
+/* A tick while compiling or reading input. */
+
+static void
+profile_idle (void)
+{
+  prof_rec *rec;
+
+  profile_tick = FALSE;
+  samples++;
+  find_rec (stacks, "(compile)")->p_self++;
+  rec = find_rec (lines, "(compile)");
+  rec->p_self++;
+  rec->p_total++;
+}
+
+
+/* Compare the line records at P1 and P2 for qsort, most samples
+   first. */
+
+static int
+rec_compare (const void *p1, const void *p2)
+{
+  const prof_rec *r1 = *(prof_rec * const *) p1;
+  const prof_rec *r2 = *(prof_rec * const *) p2;
+
+  if (r1->p_self != r2->p_self)
+    return r1->p_self < r2->p_self ? 1 : -1;
+  if (r1->p_total != r2->p_total)
+    return r1->p_total < r2->p_total ? 1 : -1;
+  return strcmp (r1->p_key, r2->p_key);
+}
+
+/* Write the folded stacks to profile_file and the lines with the
+   most samples to the error output. */
+
+void
+profile_report (void)
+{
+  prof_rec **sorted, *rec;
+  FILE *out;
+  int ix, count;
+
+  if (profile_file == NULL || getpid () != profile_pid)
+    return;
+  if (profile_tick)
+    profile_idle ();
+
+  out = fopen (profile_file, "w");
+  if (out == NULL)
+    fprintf (err_file, "bc: can not write %s\n", profile_file);
+  else
+    {
+      for (ix = 0; ix < PROF_BUCKETS; ix++)
+	for (rec = stacks[ix]; rec != NULL; rec = rec->p_next)
+	  fprintf (out, "%s %lu\n", rec->p_key, rec->p_self);
+      fclose (out);
+    }
+
+  count = 0;
+  for (ix = 0; ix < PROF_BUCKETS; ix++)
+    for (rec = lines[ix]; rec != NULL; rec = rec->p_next)
+      count++;
+  sorted = bc_malloc ((count + 1) * sizeof (prof_rec *));
+  count = 0;
+  for (ix = 0; ix < PROF_BUCKETS; ix++)
+    for (rec = lines[ix]; rec != NULL; rec = rec->p_next)
+      sorted[count++] = rec;
+  qsort (sorted, count, sizeof (prof_rec *), rec_compare);
+
+  fflush (out_file);
+  fprintf (err_file, "bc profile: %lu samples\n\n", samples);
+  if (samples == 0)
+    samples = 1;
+  fprintf (err_file, "%7s %7s  %s\n", "self%", "total%", "line");
+  for (ix = 0; ix < count && ix < 30; ix++)
+    fprintf (err_file, "%7.1f %7.1f  %s\n",
+	     100.0 * sorted[ix]->p_self / samples,
+	     100.0 * sorted[ix]->p_total / samples, sorted[ix]->p_key);
+  free (sorted);
+}
+
+
+/* A tick that came before execute started was not in the program. */
+
+void
+profile_enter (void)
+{
+  profile_idle ();
+}
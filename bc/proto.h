@@ -48,6 +48,8 @@
 
 /* From execute.c */
 void stop_execution (int);
+void limit_start (void);
+void limit_stop (void);
 unsigned char byte (program_counter *pc_);
 void execute (void);
 int prog_char (void);
@@ -60,6 +62,24 @@ void assign (char code);
 #define bc_malloc bc_num_malloc
 #define bc_realloc bc_num_realloc
 
+/* From builtin.c */
+int find_builtin (const char *name);
+int mathlib_builtin (const char *name);
+int builtin_available (int func);
+void call_builtin (program_counter *pc_, int func);
+
+/* From batch.c */
+int batch_read (char *buf, int max);
+int batch_next (void);
+void batch_end (void);
+
+/* From daemon.c */
+void daemon_start (void);
+void daemon_begin (void);
+void daemon_request (int error);
+void daemon_timeout (void);
+int daemon_metrics (char *buf);
+
 /* From util.c */
 char *strcopyof (const char *str);
 arg_list *nextarg (arg_list *args, int val, int is_var);
@@ -73,9 +93,12 @@ void generate (const char *str);
 void run_code (void);
 void out_char (int ch);
 void out_schar (int ch);
+void out_chars (const char *str, int len);
+void out_num (bc_num num);
 id_rec *find_id (id_rec *tree, const char *id);
 int insert_id_rec (id_rec **root, id_rec *new_id);
 void init_tree (void);
+void free_tree (void);
 int lookup (char *name, int namekind);
 void *bc_malloc (size_t);
 void *bc_realloc (void *, size_t, size_t);
@@ -96,14 +119,54 @@ void addbyte (unsigned char thebyte);
 void def_label (unsigned long lab);
 long long_val (const char **str);
 void load_code (const char *code);
+void load_mathlib (void);
+int code_line_of (int func, unsigned long addr);
+
+/* From map.c */
+void map_run (void);
+void aggregate_run (void);
+
+/* From profile.c */
+void profile_start (void);
+void profile_enter (void);
+void profile_sample (void);
+void profile_report (void);
+
+/* From trace.c.  TRACE (call) makes the call only with --trace. */
+#define TRACE(call) do { if (trace_file != NULL) call; } while (0)
+void trace_init (void);
+void trace_begin (const char *name);
+void trace_end (void);
+void trace_stop (void);
+void trace_start (void);
+void trace_op (const char *name, bc_num n1, bc_num n2);
+void trace_flush (FILE *file);
+#define BC_FLUSH(file) \
+  (trace_file != NULL ? trace_flush (file) : (void) fflush (file))
+void trace_report (void);
+
+/* From stats.c.  STATS (call) makes the call only with --stats, and
+   not at all when bc is built without the counters. */
+#ifdef BC_STATS
+#define STATS(call) do { if (stats_mode) call; } while (0)
+void stats_init (void);
+void stats_op (int inst);
+void stats_call (int func);
+void stats_return (int builtin);
+void stats_stop (void);
+void stats_report (void);
+#else
+#define STATS(call) do { } while (0)
+#endif
 
-/* From main.c */
+/* From main.c, or api.c for the embedded interpreter. */
 int open_new_file (void);
 void new_yy_file (FILE *file);
 void use_quit (int);
 
 /* From storage.c */
 void init_storage (void);
+void free_storage (void);
 void more_functions (void);
 void more_variables (void);
 void more_arrays (void);
@@ -132,6 +195,7 @@ void process_params (program_counter *_pc_, int func);
 /* For the scanner and parser.... */
 int yyparse (void);
 int yylex (void);
+void scan_reset (void);
 
 #if defined(LIBEDIT)
 /* The *?*&^ prompt function */
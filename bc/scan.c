@@ -738,6 +738,9 @@ char *yytext;
 /* Force . as last for now. */
 #define DOT_IS_LAST
 
+/* Each token sets the line of the code made from it. */
+#define YY_USER_ACTION code_line = line_no;
+
 /* We want to define our own yywrap. */
 #undef yywrap
 int yywrap (void);
@@ -766,8 +769,14 @@ static void
 bcel_input (char *buf, yy_size_t  *result, int max)
 {
   ssize_t rdsize;
+  if (batch_mode && yyin == stdin)
+    {
+      *result = (yy_size_t) batch_read (buf, max);
+      return;
+    }
   if (!edit || yyin != stdin)
     {
+      fflush (stdout);
       while ( (rdsize = read( fileno(yyin), buf, max )) < 0 )
         if (errno != EINTR)
 	  {
@@ -834,8 +843,14 @@ extern FILE *rl_instream;
 static void
 rl_input (char *buf, int *result, int max)
 {
+  if (batch_mode && yyin == stdin)
+    {
+      *result = batch_read (buf, max);
+      return;
+    }
   if (yyin != rl_instream)
     {
+      fflush (stdout);
       while ( (*result = read( fileno(yyin), buf, max )) < 0 )
         if (errno != EINTR)
 	  {
@@ -888,9 +903,15 @@ rl_input (char *buf, int *result, int max)
    does nothing! */
 #undef  YY_INPUT
 #define YY_INPUT(buf,result,max_size) \
-	while ( (result = read( fileno(yyin), (char *) buf, max_size )) < 0 ) \
-	    if (errno != EINTR) \
-		YY_FATAL_ERROR( "read() in flex scanner failed" );
+	if (batch_mode && yyin == stdin) \
+	  result = batch_read ((char *) buf, max_size); \
+	else \
+	  { \
+	    fflush (stdout); \
+	    while ( (result = read( fileno(yyin), (char *) buf, max_size )) < 0 ) \
+	      if (errno != EINTR) \
+		YY_FATAL_ERROR( "read() in flex scanner failed" ); \
+	  }
 #endif
 
 
@@ -1419,7 +1440,8 @@ YY_RULE_SETUP
 	      }
 	    if (c == EOF)
 	      {
-		fprintf (stderr,"EOF encountered in a comment.\n");
+		fprintf (err_file,"EOF encountered in a comment.\n");
+		error_count++;
 		break;
 	      }
 	  }
@@ -1488,7 +1510,9 @@ case 45:
 YY_RULE_SETUP
 #line 347 "../../bc/scan.l"
 {
-	  if (yytext[0] < ' ')
+	  if (yytext[0] == '"')
+	    yyerror ("EOF encountered in a string.");
+	  else if (yytext[0] < ' ')
 	    yyerror ("illegal character: ^%c",yytext[0] + '@');
 	  else
 	    if (yytext[0] > '~')
@@ -2521,3 +2545,14 @@ yywrap(void)
   yyunput(0,NULL);	/* Make sure the compiler think yyunput is used. */
 }
 
+
+/* Start the scanner over after an end of file, in the initial state.
+   Batch mode does this between requests. */
+
+void
+scan_reset (void)
+{
+  yyrestart (yyin);
+  BEGIN (INITIAL);
+}
+
@@ -0,0 +1,299 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* stats.c - count instructions, calls and numbers for --stats. */
+
+#include "bcdefs.h"
+#include "proto.h"
+#include <time.h>
+#include <sys/resource.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef BC_STATS
+
+/* Each instruction run is counted by its code, and the time until
+   the next one starts is charged to it.  Each call of a function is
+   timed from the call to the return, so the time of a function
+   includes that of the functions it calls.  A recursive call is
+   counted but not timed, as its time is in that of the outer call.  The numbers are counted
+   by number.c and the bytes by bc_malloc and bc_realloc.  None of it
+   is done unless --stats is given. */
+
+typedef struct {
+      unsigned long fs_calls;
+      unsigned long long fs_time;	/* Nanoseconds. */
+      int fs_active;			/* Calls not returned. */
+    } func_stats;
+
+static unsigned long op_count[256];
+static unsigned long long op_time[256];
+
+/* The instruction being timed and when it started. */
+static int op_last = -1;
+static unsigned long long op_start;
+
+/* The counts of each function, by function number. */
+static func_stats *func_table = NULL;
+static int func_size = 0;
+
+/* The functions being run and when each was called. */
+typedef struct {
+      int cs_func;
+      unsigned long long cs_start;
+    } call_rec;
+
+static call_rec *call_stack = NULL;
+static int call_depth = 0, call_size = 0;
+
+/* Time spent in builtins. */
+static unsigned long long builtin_time = 0;
+
+/* The process that reports, so that children do not. */
+static pid_t stats_pid;
+static unsigned long long stats_start;
+
+
+/* The time in nanoseconds. */
+
+static unsigned long long
+stats_clock (void)
+{
+  struct timespec now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (unsigned long long) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+
+/* Start counting. */
+
+void
+stats_init (void)
+{
+  stats_pid = getpid ();
+  stats_start = stats_clock ();
+}
+
+
+/* Count instruction INST and start its time. */
+
+void
+stats_op (int inst)
+{
+  unsigned long long now = stats_clock ();
+
+  if (op_last >= 0)
+    op_time[op_last] += now - op_start;
+  op_last = inst & 0xff;
+  op_start = now;
+  op_count[op_last]++;
+}
+
+
+/* Function FUNC is called. */
+
+void
+stats_call (int func)
+{
+  if (func >= func_size)
+    {
+      func_table = bc_realloc (func_table, func_size * sizeof (func_stats),
+			       (func + 32) * sizeof (func_stats));
+      memset (func_table + func_size, 0,
+	      (func + 32 - func_size) * sizeof (func_stats));
+      func_size = func + 32;
+    }
+  func_table[func].fs_calls++;
+  func_table[func].fs_active++;
+
+  if (call_depth == call_size)
+    {
+      call_stack = bc_realloc (call_stack, call_size * sizeof (call_rec),
+			       (call_size + 32) * sizeof (call_rec));
+      call_size += 32;
+    }
+  call_stack[call_depth].cs_func = func;
+  call_stack[call_depth].cs_start = stats_clock ();
+  call_depth++;
+}
+
+
+/* The function called last returns.  BUILTIN is TRUE for a builtin. */
+
+void
+stats_return (int builtin)
+{
+  func_stats *func;
+  unsigned long long spent;
+
+  if (call_depth == 0)
+    return;
+  call_depth--;
+  func = &func_table[call_stack[call_depth].cs_func];
+  if (--func->fs_active > 0)
+    return;
+  spent = stats_clock () - call_stack[call_depth].cs_start;
+  func->fs_time += spent;
+  if (builtin)
+    builtin_time += spent;
+}
+
+
+/* execute is done.  Stop the instruction time and end the calls that
+   did not return. */
+
+void
+stats_stop (void)
+{
+  if (op_last >= 0)
+    op_time[op_last] += stats_clock () - op_start;
+  op_last = -1;
+  while (call_depth > 0)
+    stats_return (FALSE);
+}
+
+
+/* Is INST an instruction whose work is done in number.c? */
+
+static int
+number_op (int inst)
+{
+  return strchr ("+-*/%^ncidAMK", inst) != NULL;
+}
+
+/* The name of an instruction for the report. */
+
+static const char *
+op_name (int inst, char *buf)
+{
+  if (inst == '"' || inst == '\\')
+    sprintf (buf, "\\%c", inst);
+  else if (inst > ' ' && inst < 127)
+    sprintf (buf, "%c", inst);
+  else
+    sprintf (buf, "\\u%04x", inst);
+  return buf;
+}
+
+#define MS(ns) ((ns) / 1e6)
+
+/* Write the report to the error output, as text or as JSON. */
+
+void
+stats_report (void)
+{
+  unsigned long long total, number_time, output_time;
+  unsigned long ops;
+  struct rusage usage;
+  char name[8];
+  int ix, first, json;
+
+  if (getpid () != stats_pid)
+    return;
+  stats_stop ();
+  json = (stats_mode == 2);
+  total = stats_clock () - stats_start;
+  ops = 0;
+  number_time = output_time = 0;
+  for (ix = 0; ix < 256; ix++)
+    {
+      ops += op_count[ix];
+      if (number_op (ix))
+	number_time += op_time[ix];
+      else if (strchr ("WPOw", ix) != NULL)
+	output_time += op_time[ix];
+    }
+  number_time += builtin_time;
+
+  fflush (out_file);
+  if (json)
+    fprintf (err_file, "{\"instructions\":{");
+  else
+    fprintf (err_file, "bc statistics\n\n%-12s %12s %12s\n",
+	     "instruction", "count", "ms");
+  for (ix = 0, first = TRUE; ix < 256; ix++)
+    if (op_count[ix] != 0)
+      {
+	op_name (ix, name);
+	if (json)
+	  fprintf (err_file, "%s\"%s\":{\"count\":%lu,\"ns\":%llu}",
+		   first ? "" : ",", name, op_count[ix], op_time[ix]);
+	else
+	  fprintf (err_file, "%-12s %12lu %12.3f\n",
+		   name, op_count[ix], MS (op_time[ix]));
+	first = FALSE;
+      }
+
+  if (json)
+    fprintf (err_file, "},\"functions\":{");
+  else
+    fprintf (err_file, "\n%-12s %12s %12s\n", "function", "calls", "ms");
+  for (ix = 0, first = TRUE; ix < func_size; ix++)
+    if (func_table[ix].fs_calls != 0)
+      {
+	if (json)
+	  fprintf (err_file, "%s\"%s\":{\"calls\":%lu,\"ns\":%llu}",
+		   first ? "" : ",", f_names[ix], func_table[ix].fs_calls,
+		   func_table[ix].fs_time);
+	else
+	  fprintf (err_file, "%-12s %12lu %12.3f\n", f_names[ix],
+		   func_table[ix].fs_calls, MS (func_table[ix].fs_time));
+	first = FALSE;
+      }
+
+  getrusage (RUSAGE_SELF, &usage);
+  if (json)
+    fprintf (err_file,
+	     "},\"numbers\":{\"new\":%lu,\"reused\":%lu,\"bytes\":%lu},"
+	     "\"memory\":{\"number_bytes\":%lu,\"number_peak\":%lu,"
+	     "\"max_rss_kb\":%ld},"
+	     "\"time\":{\"total_ns\":%llu,\"number_ns\":%llu,"
+	     "\"output_ns\":%llu,\"other_ns\":%llu,\"instructions\":%lu}}\n",
+	     bc_stats_new, bc_stats_reused, stats_bytes,
+	     (unsigned long) bc_mem_bytes, (unsigned long) bc_mem_peak,
+	     usage.ru_maxrss, total, number_time, output_time,
+	     total - MIN (total, number_time + output_time), ops);
+  else
+    fprintf (err_file,
+	     "\nnumbers made %lu, %lu of them from the free list\n"
+	     "bytes allocated %lu\n"
+	     "number bytes in use %lu, at most %lu\n"
+	     "max resident set %ld kB\n\n"
+	     "instructions %lu\n"
+	     "total ms %.3f\n"
+	     "  number.c (arithmetic and builtins) %.3f\n"
+	     "  output %.3f\n"
+	     "  interpreter, parsing and the rest %.3f\n",
+	     bc_stats_new, bc_stats_reused, stats_bytes,
+	     (unsigned long) bc_mem_bytes, (unsigned long) bc_mem_peak,
+	     usage.ru_maxrss, ops, MS (total),
+	     MS (number_time), MS (output_time),
+	     MS (total - MIN (total, number_time + output_time)));
+}
+
+#endif
@@ -67,6 +67,71 @@ init_storage (void)
   bc_init_numbers();
 }
 
+
+/* Free all of the storage, for an embedded interpreter that is being
+   destroyed.  The variables and arrays include any autos left by a
+   function that did not return. */
+
+void
+free_storage (void)
+{
+  bc_var *v_temp;
+  bc_var_array *a_temp;
+  int indx;
+
+  while (ex_stack != NULL) pop();
+  while (fn_stack != NULL) fpop();
+
+  for (indx = 0; indx < f_count; indx++)
+    {
+      clear_func (indx);
+      free (functions[indx].f_body);
+      free (functions[indx].f_lines);
+      if (f_names[indx] != NULL)
+	free (f_names[indx]);
+    }
+  free (functions);
+  free (f_names);
+
+  for (indx = 3; indx < v_count; indx++)
+    {
+      while ((v_temp = variables[indx]) != NULL)
+	{
+	  variables[indx] = v_temp->v_next;
+	  bc_free_num (&v_temp->v_value);
+	  free (v_temp);
+	}
+      if (v_names[indx] != NULL)
+	free (v_names[indx]);
+    }
+  free (variables);
+  free (v_names);
+
+  for (indx = 1; indx < a_count; indx++)
+    {
+      while ((a_temp = arrays[indx]) != NULL)
+	{
+	  arrays[indx] = a_temp->a_next;
+	  if (!a_temp->a_param && a_temp->a_value != NULL)
+	    {
+	      free_a_tree (a_temp->a_value->a_tree,
+			   a_temp->a_value->a_depth);
+	      free (a_temp->a_value);
+	    }
+	  free (a_temp);
+	}
+      if (a_names[indx] != NULL)
+	free (a_names[indx]);
+    }
+  free (arrays);
+  free (a_names);
+
+  f_count = v_count = a_count = 0;
+  bc_free_num (&_zero_);
+  bc_free_num (&_one_);
+  bc_free_num (&_two_);
+}
+
 /* Three functions for increasing the number of functions, variables, or
    arrays that are needed.  This adds another 32 of the requested object. */
 
@@ -102,12 +167,18 @@ more_functions (void)
       f = &functions[indx];
       f->f_defined = FALSE;
       f->f_void = FALSE;
+      f->f_builtin = 0;
       f->f_body = bc_malloc (BC_START_SIZE);
       f->f_body_size = BC_START_SIZE;
       f->f_code_size = 0;
       f->f_label = NULL;
       f->f_autos = NULL;
       f->f_params = NULL;
+      f->f_lines = NULL;
+      f->f_line_count = 0;
+      f->f_line_size = 0;
+      f->f_file = NULL;
+      f_names[indx] = NULL;
     }
 
   /* Free the old elements. */
@@ -145,7 +216,10 @@ more_variables (void)
 
   /* Initialize the new elements. */
   for (; indx < v_count; indx++)
-    variables[indx] = NULL;
+    {
+      variables[indx] = NULL;
+      v_names[indx] = NULL;
+    }
 
   /* Free the old elements. */
   if (old_count != 0)
@@ -183,7 +257,10 @@ more_arrays (void)
 
   /* Initialize the new elements. */
   for (; indx < a_count; indx++)
-    arrays[indx] = NULL;
+    {
+      arrays[indx] = NULL;
+      a_names[indx] = NULL;
+    }
 
   /* Free the old elements. */
   if (old_count != 0)
@@ -207,6 +284,8 @@ clear_func (int func)
   f->f_defined = FALSE;
   /* XXX restore f_body to initial size??? */
   f->f_code_size = 0;
+  f->f_line_count = 0;
+  f->f_file = NULL;
   if (f->f_autos != NULL)
     {
       free_args (f->f_autos);
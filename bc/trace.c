@@ -0,0 +1,300 @@
+/*  This file is part of GNU bc.
+
+    Copyright (C) 1991-1994, 1997, 2006, 2008, 2012-2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, see
+    <http://www.gnu.org/licenses>.
+
+    You may contact the author by:
+       e-mail:  philnelson@acm.org
+      us-mail:  Philip A. Nelson
+                Computer Science Department, 9062
+                Western Washington University
+                Bellingham, WA 98226-9062
+
+*************************************************************************/
+/* trace.c - record a timeline of calls and long operations, for --trace. */
+
+#include "bcdefs.h"
+#include "proto.h"
+#include <time.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+/* Each thread that records an event gets a ring of TRACE_EVENTS
+   events, kept in a list that is only ever pushed on, so recording
+   takes no lock.  When a ring is full the oldest events are lost.  At
+   exit the rings are written as Chrome trace events, which
+   chrome://tracing and Perfetto read: a "B" and "E" pair for each call
+   of a function, and an "X" event with its length for each operation
+   on numbers of TRACE_LIMBS or more limbs and each flush of output. */
+
+#define TRACE_EVENTS 65536
+#define TRACE_LIMBS  64
+
+typedef struct {
+      unsigned long long e_time;	/* Nanoseconds. */
+      unsigned long long e_length;	/* For "X" events. */
+      const char *e_name;
+      size_t e_limbs;
+      char e_phase;
+    } trace_event;
+
+typedef struct trace_ring {
+      trace_event *r_events;
+      unsigned long r_count;		/* Events recorded, not all kept. */
+      int r_tid;
+      struct trace_ring *r_next;
+    } trace_ring;
+
+static trace_ring *rings = NULL;
+static int ring_count = 0;
+static __thread trace_ring *my_ring = NULL;
+
+/* When the operation being timed started. */
+static __thread unsigned long long op_start;
+
+/* The calls not yet returned, for those ended by an error. */
+static __thread int call_depth = 0;
+
+/* The process that reports, so that children do not. */
+static pid_t trace_pid;
+static unsigned long long trace_origin;
+
+
+/* The time in nanoseconds. */
+
+static unsigned long long
+trace_clock (void)
+{
+  struct timespec now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (unsigned long long) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+
+/* Make the ring of this thread.  It is not counted as memory of the
+   program, and tracing just stops if there is none. */
+
+static trace_ring *
+new_ring (void)
+{
+  trace_ring *ring;
+
+  ring = malloc (sizeof (trace_ring));
+  if (ring == NULL)
+    return NULL;
+  ring->r_events = malloc (TRACE_EVENTS * sizeof (trace_event));
+  if (ring->r_events == NULL)
+    {
+      free (ring);
+      return NULL;
+    }
+  ring->r_count = 0;
+  ring->r_tid = __sync_add_and_fetch (&ring_count, 1);
+  do
+    ring->r_next = rings;
+  while (!__sync_bool_compare_and_swap (&rings, ring->r_next, ring));
+  my_ring = ring;
+  return ring;
+}
+
+
+/* Start tracing.  The main thread is thread 1. */
+
+void
+trace_init (void)
+{
+  trace_pid = getpid ();
+  trace_origin = trace_clock ();
+  new_ring ();
+}
+
+
+/* The next event of this thread, or NULL if there is no room. */
+
+static trace_event *
+new_event (char phase, const char *name)
+{
+  trace_ring *ring = my_ring;
+  trace_event *event;
+
+  if (ring == NULL && (ring = new_ring ()) == NULL)
+    return NULL;
+
+  event = &ring->r_events[ring->r_count++ % TRACE_EVENTS];
+  event->e_phase = phase;
+  event->e_name = name;
+  event->e_length = 0;
+  event->e_limbs = 0;
+  return event;
+}
+
+
+/* A call of NAME starts or ends. */
+
+void
+trace_begin (const char *name)
+{
+  trace_event *event = new_event ('B', name);
+
+  if (event != NULL)
+    event->e_time = trace_clock ();
+  call_depth++;
+}
+
+void
+trace_end (void)
+{
+  trace_event *event = new_event ('E', NULL);
+
+  if (event != NULL)
+    event->e_time = trace_clock ();
+  call_depth--;
+}
+
+
+/* End the calls left when execute stopped on an error. */
+
+void
+trace_stop (void)
+{
+  while (call_depth > 0)
+    trace_end ();
+}
+
+
+/* Time an operation.  trace_op records it if N1 or N2 is large. */
+
+void
+trace_start (void)
+{
+  op_start = trace_clock ();
+}
+
+void
+trace_op (const char *name, bc_num n1, bc_num n2)
+{
+  trace_event *event;
+  size_t limbs;
+
+  limbs = mpz_size (n1->n_value);
+  if (n2 != NULL && mpz_size (n2->n_value) > limbs)
+    limbs = mpz_size (n2->n_value);
+  if (limbs < TRACE_LIMBS)
+    return;
+
+  event = new_event ('X', name);
+  if (event != NULL)
+    {
+      event->e_time = op_start;
+      event->e_length = trace_clock () - op_start;
+      event->e_limbs = limbs;
+    }
+}
+
+
+/* Flush FILE, recording the time it took. */
+
+void
+trace_flush (FILE *file)
+{
+  trace_event *event;
+  unsigned long long start;
+
+  start = trace_clock ();
+  fflush (file);
+  event = new_event ('X', "flush");
+  if (event != NULL)
+    {
+      event->e_time = start;
+      event->e_length = trace_clock () - start;
+    }
+}
+
+
+/* Write the events of RING to OUT.  An "E" whose "B" was lost from
+   the ring is left out, and calls not ended are ended at the last
+   event. */
+
+static void
+write_ring (FILE *out, trace_ring *ring, int *first)
+{
+  unsigned long ix, start;
+  unsigned long long last = 0;
+  trace_event *event;
+  int depth = 0;
+
+  start = (ring->r_count > TRACE_EVENTS ? ring->r_count - TRACE_EVENTS : 0);
+  for (ix = start; ix < ring->r_count; ix++)
+    {
+      event = &ring->r_events[ix % TRACE_EVENTS];
+      if (event->e_phase == 'E' && depth == 0)
+	continue;
+      depth += (event->e_phase == 'B') - (event->e_phase == 'E');
+      last = event->e_time + event->e_length;
+
+      fprintf (out, "%s\n{\"ph\":\"%c\",\"pid\":%ld,\"tid\":%d,\"ts\":%.3f",
+	       *first ? "" : ",", event->e_phase, (long) trace_pid,
+	       ring->r_tid, (event->e_time - trace_origin) / 1000.0);
+      *first = FALSE;
+      if (event->e_name != NULL)
+	fprintf (out, ",\"name\":\"%s\"", event->e_name);
+      if (event->e_phase == 'X')
+	fprintf (out, ",\"dur\":%.3f", event->e_length / 1000.0);
+      if (event->e_limbs != 0)
+	fprintf (out, ",\"args\":{\"limbs\":%lu}",
+		 (unsigned long) event->e_limbs);
+      fprintf (out, "}");
+    }
+
+  for (; depth > 0; depth--)
+    fprintf (out, ",\n{\"ph\":\"E\",\"pid\":%ld,\"tid\":%d,\"ts\":%.3f}",
+	     (long) trace_pid, ring->r_tid, (last - trace_origin) / 1000.0);
+}
+
+
+/* Write the trace to trace_file. */
+
+void
+trace_report (void)
+{
+  FILE *out;
+  trace_ring *ring;
+  int first = TRUE;
+
+  if (getpid () != trace_pid)
+    return;
+
+  out = fopen (trace_file, "w");
+  if (out == NULL)
+    {
+      fprintf (err_file, "bc: can not write %s\n", trace_file);
+      return;
+    }
+  fprintf (out, "{\"traceEvents\":[");
+  for (ring = rings; ring != NULL; ring = ring->r_next)
+    {
+      fprintf (out, "%s\n{\"ph\":\"M\",\"pid\":%ld,\"tid\":%d,"
+	       "\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+	       first ? "" : ",", (long) trace_pid, ring->r_tid,
+	       ring->r_tid == 1 ? "bc" : "worker");
+      first = FALSE;
+      write_ring (out, ring, &first);
+    }
+  fprintf (out, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  fclose (out);
+}
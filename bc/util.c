@@ -283,6 +283,10 @@ generate (const char *str)
 void
 run_code(void)
 {
+  /* The code of a --map program is kept to be run for each record. */
+  if (map_compiling)
+    return;
+
   /* If no compile errors run the current code. */
   if (!had_error && did_gen)
     {
@@ -291,6 +295,14 @@ run_code(void)
 	  printf ("@r\n"); 
 	  out_count = 0;
 	}
+      else if (interactive && is_std_in)
+	{
+	  /* Each line typed is a run of its own, so a limit stops
+	     only that line. */
+	  limit_start ();
+	  execute ();
+	  limit_stop ();
+	}
       else
 	execute ();
     }
@@ -313,18 +325,77 @@ out_char (int ch)
   if (ch == '\n')
     {
       out_col = 0;
-      putchar ('\n');
+      putc ('\n', out_file);
     }
   else
     {
       out_col++;
       if (out_col == line_size-1 && line_size != 0)
 	{
-	  putchar ('\\');
-	  putchar ('\n');
+	  putc ('\\', out_file);
+	  putc ('\n', out_file);
 	  out_col = 1;
 	}
-      putchar (ch);
+      putc (ch, out_file);
+    }
+}
+
+/* Output routines: Write the LEN characters of STR, none of them a
+   newline, just as out_char would.  The characters between line
+   breaks are written as a block rather than one at a time. */
+
+void
+out_chars (const char *str, int len)
+{
+  int room;
+
+  while (len > 0)
+    {
+      /* Without a line length, or past the break column, there is no
+	 break to make. */
+      if (line_size == 0 || out_col >= line_size-1)
+	{
+	  fwrite (str, 1, len, out_file);
+	  out_col += len;
+	  return;
+	}
+      room = line_size-2 - out_col;
+      if (room == 0)
+	{
+	  fwrite ("\\\n", 1, 2, out_file);
+	  out_col = 0;
+	  room = line_size-2;
+	}
+      if (room > len)
+	room = len;
+      fwrite (str, 1, room, out_file);
+      out_col += room;
+      str += room;
+      len -= room;
+    }
+}
+
+/* Output routines: Write NUM to the standard output in base o_base.
+   Base 10, the common case, is formatted in a buffer on the stack
+   and written in blocks by out_chars. */
+
+void
+out_num (bc_num num)
+{
+  char buf[BC_DEC_BUF], *str;
+  int len;
+
+  if (o_base != 10)
+    bc_out_num (num, o_base, out_char, std_only);
+  else if (bc_is_zero (num))
+    out_char ('0');
+  else if ((len = bc_num2dec (num, buf, sizeof (buf))) >= 0)
+    out_chars (buf, len);
+  else
+    {
+      str = bc_num2str (num);
+      out_chars (str, strlen (str));
+      free (str);
     }
 }
 
@@ -339,7 +410,7 @@ out_schar (int ch)
   if (ch == '\n')
     {
       out_col = 0;
-      putchar ('\n');
+      putc ('\n', out_file);
     }
   else
     {
@@ -348,12 +419,12 @@ out_schar (int ch)
 	  out_col++;
 	  if (out_col == line_size-1 && line_size != 0)
 	    {
-	      putchar ('\\');
-	      putchar ('\n');
+	      putc ('\\', out_file);
+	      putc ('\n', out_file);
 	      out_col = 1;
 	    }
 	}
-      putchar (ch);
+      putc (ch, out_file);
     }
 }
 
@@ -530,6 +601,30 @@ init_tree(void)
 }
 
 
+/* Free the name tree ROOT. */
+
+static void
+free_id_recs (id_rec *root)
+{
+  if (root != NULL)
+    {
+      free_id_recs (root->left);
+      free_id_recs (root->right);
+      free (root->id);
+      free (root);
+    }
+}
+
+/* Free the symbol table tree and start a new one. */
+
+void
+free_tree (void)
+{
+  free_id_recs (name_tree);
+  init_tree ();
+}
+
+
 /* Lookup routines for symbol table names. */
 
 int
@@ -538,7 +633,7 @@ lookup (char *name, int  namekind)
   id_rec *id;
 
   /* Warn about non-standard name. */
-  if (strlen(name) != 1)
+  if (strlen(name) != 1 && !(use_math && mathlib_builtin (name)))
     ct_warn ("multiple letter name - %s", name);
 
   /* Look for the id. */
@@ -583,7 +678,7 @@ lookup (char *name, int  namekind)
 	{
           free(name);
 	  /* Check to see if we are redefining a math lib function. */ 
-	  if (use_math && namekind == FUNCTDEF && id->f_name <= 6)
+	  if (use_math && namekind == FUNCTDEF && id->f_name <= 7)
 	    id->f_name = next_func++;
 	  return (id->f_name);
 	}
@@ -593,6 +688,7 @@ lookup (char *name, int  namekind)
 	  if (id->f_name >= f_count)
 	    more_functions ();
           f_names[id->f_name] = name;
+	  functions[id->f_name].f_builtin = find_builtin (name);
 	  return (id->f_name);
 	}
       yyerror ("Too many functions");
@@ -630,14 +726,14 @@ lookup (char *name, int  namekind)
 void
 limits(void)
 {
-  printf ("BC_BASE_MAX     = %d\n",  BC_BASE_MAX);
-  printf ("BC_DIM_MAX      = %ld\n", (long) BC_DIM_MAX);
-  printf ("BC_SCALE_MAX    = %d\n",  BC_SCALE_MAX);
-  printf ("BC_STRING_MAX   = %d\n",  BC_STRING_MAX);
-  printf ("MAX Exponent    = %ld\n", (long) LONG_MAX);
-  printf ("Number of vars  = %ld\n", (long) MAX_STORE);
+  fprintf (out_file, "BC_BASE_MAX     = %d\n",  BC_BASE_MAX);
+  fprintf (out_file, "BC_DIM_MAX      = %ld\n", (long) BC_DIM_MAX);
+  fprintf (out_file, "BC_SCALE_MAX    = %d\n",  BC_SCALE_MAX);
+  fprintf (out_file, "BC_STRING_MAX   = %d\n",  BC_STRING_MAX);
+  fprintf (out_file, "MAX Exponent    = %ld\n", (long) LONG_MAX);
+  fprintf (out_file, "Number of vars  = %ld\n", (long) MAX_STORE);
 #ifdef OLD_EQ_OP
-  printf ("Old assignment operatiors are valid. (=-, =+, ...)\n");
+  fprintf (out_file, "Old assignment operatiors are valid. (=-, =+, ...)\n");
 #endif 
 }
 
@@ -652,23 +748,30 @@ bc_malloc (size_t size)
   ptr = (void *) malloc (size);
   if (ptr == NULL)
     out_of_memory ();
+#ifdef BC_STATS
+  /* GMP allocates from the threads of bsplit.c and map.c too. */
+  __sync_fetch_and_add (&stats_bytes, size);
+#endif
 
   return ptr;
 }
 
 /* bc_realloc will check the return value so all other places do not
-   have to do it!  NEWSIZE is the number of bytes to allocate. */
+   have to do it!  NEWSIZE is the number of bytes to allocate and
+   OLDSIZE the number there were. */
 
 void *
 bc_realloc (void *oldptr, size_t oldsize, size_t newsize)
 {
   void *ptr;
 
-  oldsize = 0; /* Shut up, compiler! */
-
   ptr = (void *) realloc (oldptr, newsize);
   if (ptr == NULL)
     out_of_memory ();
+#ifdef BC_STATS
+  if (newsize > oldsize)
+    __sync_fetch_and_add (&stats_bytes, newsize - oldsize);
+#endif
 
   return ptr;
 }
@@ -681,7 +784,7 @@ bc_realloc (void *oldptr, size_t oldsize, size_t newsize)
 void
 out_of_memory(void)
 {
-  fprintf (stderr, "Fatal error: Out of memory for malloc.\n");
+  fprintf (err_file, "Fatal error: Out of memory for malloc.\n");
   bc_exit (1);
   /*NOTREACHED*/
 }
@@ -717,10 +820,12 @@ yyerror (str, va_alist)
     name = "(standard_in)";
   else
     name = file_name;
-  fprintf (stderr,"%s %d: ",name,line_no);
-  vfprintf (stderr, str, args);
-  fprintf (stderr, "\n");
+  BC_FLUSH (out_file);
+  fprintf (err_file,"%s %d: ",name,line_no);
+  vfprintf (err_file, str, args);
+  fprintf (err_file, "\n");
   had_error = TRUE;
+  error_count++;
   va_end (args);
 }
 
@@ -757,10 +862,12 @@ ct_warn (mesg, va_alist)
 	name = "(standard_in)";
       else
 	name = file_name;
-      fprintf (stderr,"%s %d: Error: ",name,line_no);
-      vfprintf (stderr, mesg, args);
-      fprintf (stderr, "\n");
+      BC_FLUSH (out_file);
+      fprintf (err_file,"%s %d: Error: ",name,line_no);
+      vfprintf (err_file, mesg, args);
+      fprintf (err_file, "\n");
       had_error = TRUE;
+      error_count++;
     }
   else
     if (warn_not_std)
@@ -769,9 +876,10 @@ ct_warn (mesg, va_alist)
 	  name = "(standard_in)";
 	else
 	  name = file_name;
-	fprintf (stderr,"%s %d: (Warning) ",name,line_no);
-	vfprintf (stderr, mesg, args);
-	fprintf (stderr, "\n");
+	BC_FLUSH (out_file);
+	fprintf (err_file,"%s %d: (Warning) ",name,line_no);
+	vfprintf (err_file, mesg, args);
+	fprintf (err_file, "\n");
       }
   va_end (args);
 }
@@ -795,18 +903,20 @@ rt_error (mesg, va_alist)
 {
   va_list args;
 
-  fprintf (stderr, "Runtime error (func=%s, adr=%d): ",
+  BC_FLUSH (out_file);
+  fprintf (err_file, "Runtime error (func=%s, adr=%d): ",
 	   f_names[pc.pc_func], pc.pc_addr);
 #ifndef VARARGS   
   va_start (args, mesg);
 #else
   va_start (args);
 #endif
-  vfprintf (stderr, mesg, args);
+  vfprintf (err_file, mesg, args);
   va_end (args);
   
-  fprintf (stderr, "\n");
+  fprintf (err_file, "\n");
   runtime_error = TRUE;
+  error_count++;
 }
 
 
@@ -829,23 +939,34 @@ rt_warn (const char *mesg)
 {
   va_list args;
 
-  fprintf (stderr, "Runtime warning (func=%s, adr=%d): ",
+  BC_FLUSH (out_file);
+  fprintf (err_file, "Runtime warning (func=%s, adr=%d): ",
 	   f_names[pc.pc_func], pc.pc_addr);
 #ifndef VARARGS   
   va_start (args, mesg);
 #else
   va_start (args);
 #endif
-  vfprintf (stderr, mesg, args);
+  vfprintf (err_file, mesg, args);
   va_end (args);
 
-  fprintf (stderr, "\n");
+  fprintf (err_file, "\n");
 }
 
 /* bc_exit: Make sure to reset the edit state. */
 
 void bc_exit(int val)
 {
+  if (exit_jump != NULL)
+    {
+      exit_status = val;
+      longjmp (*exit_jump, 1);
+    }
+  if (batch_mode)
+    batch_end ();
+  STATS (stats_report ());
+  TRACE (trace_report ());
+  profile_report ();
 #if defined(LIBEDIT)
   if (edit != NULL)
     el_end(edit);
@@ -38,15 +38,15 @@
 void 
 welcome()
 {
-  printf ("This is free software with ABSOLUTELY NO WARRANTY.\n");
-  printf ("For details type `warranty'. \n");
+  fprintf (out_file, "This is free software with ABSOLUTELY NO WARRANTY.\n");
+  fprintf (out_file, "For details type `warranty'. \n");
 }
 
 /* Print out the version information. */
 void
 show_bc_version()
 {
-  printf("%s %s\n%s\n", PACKAGE, VERSION, BC_COPYRIGHT);
+  fprintf (out_file, "%s %s\n%s\n", PACKAGE, VERSION, BC_COPYRIGHT);
 }
 
 
@@ -56,9 +56,9 @@ void
 warranty(prefix)
      const char *prefix;
 {
-  printf ("\n%s", prefix);
+  fprintf (out_file, "\n%s", prefix);
   show_bc_version ();
-  printf ("\n"
+  fprintf (out_file, "\n"
 "    This program is free software; you can redistribute it and/or modify\n"
 "    it under the terms of the GNU General Public License as published by\n"
 "    the Free Software Foundation; either version 3 of the License , or\n"
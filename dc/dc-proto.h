@@ -36,6 +36,7 @@ extern void dc_binop2 DC_PROTO((int (*)(dc_num, dc_num, int,
 								dc_num *, dc_num *), int));
 extern void dc_triop DC_PROTO((int (*)(dc_num, dc_num, dc_num, int,
 								dc_num *), int));
+extern void dc_hyperop DC_PROTO((int));
 extern void dc_clear_stack DC_PROTO((void));
 extern void dc_dump_num(dc_num, dc_discard);
 extern void dc_free_num DC_PROTO((dc_num *));
@@ -43,6 +44,8 @@ extern void dc_free_str DC_PROTO((dc_str *));
 extern void dc_garbage DC_PROTO((const char *, int));
 extern void dc_math_init DC_PROTO((void));
 extern void dc_memfail DC_PROTO((void));
+extern void dc_mem_limit DC_PROTO((size_t));
+extern void dc_mem_report DC_PROTO((void));
 extern void dc_out_num DC_PROTO((dc_num, int, dc_discard));
 extern void dc_out_str DC_PROTO((dc_str, dc_discard));
 extern void dc_print DC_PROTO((dc_data, int, dc_newline, dc_discard));
@@ -59,6 +62,7 @@ extern int  dc_cmpop DC_PROTO((void));
 extern int  dc_compare DC_PROTO((dc_num, dc_num));
 extern int  dc_evalfile DC_PROTO((FILE *));
 extern int  dc_evalstr DC_PROTO((dc_data *));
+extern int  dc_mem_exceeded DC_PROTO((void));
 extern int  dc_num2int DC_PROTO((dc_num, dc_discard));
 extern int  dc_numlen DC_PROTO((dc_num));
 extern int  dc_pop DC_PROTO((dc_data *));
@@ -90,3 +94,6 @@ extern int dc_mul DC_PROTO((dc_num, dc_num, int, dc_num *));
 extern int dc_rem DC_PROTO((dc_num, dc_num, int, dc_num *));
 extern int dc_sub DC_PROTO((dc_num, dc_num, int, dc_num *));
 extern int dc_sqrt DC_PROTO((dc_num, int, dc_num *));
+extern int dc_constant DC_PROTO((int, int, dc_num *));
+extern int dc_hypergeometric DC_PROTO((dc_num *, int, dc_num *, int, dc_num,
+										int, dc_num *));
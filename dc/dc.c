@@ -81,6 +81,7 @@ Usage: %s [OPTION] [file ...]\n\
   -e, --expression=EXPR    evaluate expression\n\
   -f, --file=FILE          evaluate contents of file\n\
   -h, --help               display this help and exit\n\
+      --max-memory=SIZE    stop a macro holding more than SIZE bytes of numbers\n\
   -V, --version            output version information and exit\n\
 \n\
 ", progname);
@@ -102,6 +103,22 @@ r1bindex DC_DECLARG((s, c))
 	return p + 1;
 }
 
+/* a size in bytes, with an optional K, M or G; 0 if it is not one */
+static size_t
+parse_size DC_DECLARG((text))
+	const char *text DC_DECLEND
+{
+	char *end;
+	unsigned long size = strtoul(text, &end, 10);
+
+	switch (*end) {
+	case 'k': case 'K': size <<= 10; ++end; break;
+	case 'm': case 'M': size <<= 20; ++end; break;
+	case 'g': case 'G': size <<= 30; ++end; break;
+	}
+	return *end == '\0' ? size : 0;
+}
+
 static void
 try_file(const char *filename)
 {
@@ -253,6 +270,7 @@ main DC_DECLARG((argc, argv))
 		{"expression", required_argument, NULL, 'e'},
 		{"file", required_argument, NULL, 'f'},
 		{"help", no_argument, NULL, 'h'},
+		{"max-memory", required_argument, NULL, 'm'},
 		{"version", no_argument, NULL, 'V'},
 		{NULL, 0, NULL, 0}
 	};
@@ -282,6 +300,15 @@ main DC_DECLARG((argc, argv))
 		case 'h':
 			usage(stdout);
 			return flush_okay();
+		case 'm':
+			{	size_t limit = parse_size(optarg);
+				if (limit == 0) {
+					usage(stderr);
+					return EXIT_FAILURE;
+				}
+				dc_mem_limit(limit);
+			}
+			break;
 		case 'V':
 			show_version();
 			return flush_okay();
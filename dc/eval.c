@@ -391,6 +391,11 @@ between 2 and %d (inclusive)\n",
 		dc_push(dc_int2data(dc_tell_stackdepth()));
 		break;
 
+	case 'H':	/* replace  a1 ... ap p b1 ... bq q z  on the stack with
+				 * the hypergeometric series pFq(a1..ap; b1..bq; z)
+				 */
+		dc_hyperop(dc_scale);
+		break;
 	case 'I':	/* push the current input base onto the stack */
 		dc_push(dc_int2data(dc_ibase));
 		break;
@@ -462,6 +467,22 @@ between 2 and %d (inclusive)\n",
 		if (dc_pop(&datum) == DC_SUCCESS)
 			dc_register_push(peekc, datum);
 		return DC_EATONE;
+	case 'T':	/* replace the number on top-of-stack with that
+				 * constant: 0 pi, 1 ln(2), 2 ln(10), 3 e
+				 */
+		if (dc_pop(&datum) == DC_SUCCESS){
+			if (datum.dc_type == DC_NUMBER){
+				tmpint = dc_num2int(datum.v.number, DC_TOSS);
+				if (dc_constant(tmpint, dc_scale, &datum.v.number) == DC_SUCCESS)
+					dc_push(datum);
+			}else if (datum.dc_type == DC_STRING){
+				fprintf(stderr, "%s: non-numeric value\n", progname);
+				dc_free_str(&datum.v.string);
+			}else{
+				dc_garbage("at top of stack", -1);
+			}
+		}
+		break;
 	case 'X':	/* replace the number on top-of-stack with its scale factor */
 		if (dc_pop(&datum) == DC_SUCCESS){
 			tmpint = 0;
@@ -543,7 +564,7 @@ evalstr DC_DECLARG((string))
 	interrupt_seen = 0;
 	s = dc_str2charp(string->v.string);
 	end = s + dc_strlen(string->v.string);
-	while (s < end && interrupt_seen==0){
+	while (s < end && interrupt_seen==0 && !dc_mem_exceeded()){
 		c = *(const unsigned char *)s++;
 		peekc = EOF;
 		if (s < end)
@@ -645,7 +666,10 @@ evalstr DC_DECLARG((string))
 int
 dc_evalstr(dc_data *string)
 {
-   switch (evalstr(string)) {
+   int status = evalstr(string);
+
+   dc_mem_report();
+   switch (status) {
    case DC_OKAY:
 	   return DC_SUCCESS;
    case DC_QUIT:
@@ -805,6 +829,7 @@ string execution depth\n", progname);
 		if (interrupt_seen)
 			fprintf(stderr, "\nInterrupt!\n");
 		interrupt_seen = 0;
+		dc_mem_report();
 		signal(SIGINT, sigint_default);
 	}
 	if (!ferror(fp))
@@ -208,6 +208,11 @@ dc_exp DC_DECLARG((a, b, kscale, result))
 {
 	bc_init_num(CastNumPtr(result));
 	bc_raise(CastNum(a), CastNum(b), CastNumPtr(result), kscale);
+	if (bc_mem_exceeded){
+		/* the power was too large to try */
+		bc_free_num(CastNumPtr(result));
+		return DC_FAIL;
+	}
 	return DC_SUCCESS;
 }
 
@@ -232,6 +237,65 @@ dc_sqrt DC_DECLARG((value, kscale, result))
 	return DC_SUCCESS;
 }
 
+/* place mathematical constant number which (0 is pi, 1 is ln(2),
+ * 2 is ln(10) and 3 is e) into *result;
+ * return DC_SUCCESS on success, DC_DOMAIN_ERROR on domain error
+ */
+int
+dc_constant DC_DECLARG((which, kscale, result))
+	int which DC_DECLSEP
+	int kscale DC_DECLSEP
+	dc_num *result DC_DECLEND
+{
+	bc_init_num(CastNumPtr(result));
+	switch (bc_constant(which, kscale, CastNumPtr(result))){
+	case -1:
+		fprintf(stderr, "%s: no such constant\n", progname);
+		break;
+	case -2:
+		/* stopped by the memory limit, which is reported */
+		break;
+	default:
+		return DC_SUCCESS;
+	}
+	bc_free_num(CastNumPtr(result));
+	return DC_DOMAIN_ERROR;
+}
+
+/* place the hypergeometric series pFq(a[0]..a[p-1]; b[0]..b[q-1]; z)
+ * into *result;
+ * return DC_SUCCESS on success, DC_DOMAIN_ERROR on domain error
+ */
+int
+dc_hypergeometric DC_DECLARG((a, p, b, q, z, kscale, result))
+	dc_num *a DC_DECLSEP
+	int p DC_DECLSEP
+	dc_num *b DC_DECLSEP
+	int q DC_DECLSEP
+	dc_num z DC_DECLSEP
+	int kscale DC_DECLSEP
+	dc_num *result DC_DECLEND
+{
+	bc_init_num(CastNumPtr(result));
+	switch (bc_hypergeometric(CastNumPtr(a), p, CastNumPtr(b), q,
+							  CastNum(z), kscale, CastNumPtr(result))){
+	case -1:
+		fprintf(stderr, "%s: b is zero or a negative integer in hypergeometric\n", progname);
+		break;
+	case -2:
+		fprintf(stderr, "%s: hypergeometric series does not converge\n",
+				progname);
+		break;
+	case -3:
+		/* stopped by the memory limit, which is reported */
+		break;
+	default:
+		return DC_SUCCESS;
+	}
+	bc_free_num(CastNumPtr(result));
+	return DC_DOMAIN_ERROR;
+}
+
 /* compare dc_nums a and b;
  *  return a negative value if a < b;
  *  return a positive value if a > b;
@@ -282,14 +346,79 @@ dc_int2data DC_DECLARG((value))
 	return result;
 }
 
+/* The digits of the number being read by dc_getnum, as the
+ * characters 0-9 and a-f.
+ */
+static char *getnum_digits = NULL;
+static int getnum_size = 0;
+
+static void
+dc_getnum_digit DC_DECLARG((pos, digit))
+	int pos DC_DECLSEP
+	int digit DC_DECLEND
+{
+	if (pos >= getnum_size){
+		getnum_digits = dc_realloc(getnum_digits, getnum_size,
+					   getnum_size + 64);
+		getnum_size += 64;
+	}
+	getnum_digits[pos] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+}
+
+/* Convert the LEN digits gathered, FRAC_LEN of them after the point,
+ * one digit at a time.  This is for numbers with a digit not less
+ * than IBASE, which bc_digits2num does not take.
+ */
+static bc_num
+dc_getnum_slow DC_DECLARG((ibase, len, frac_len))
+	int ibase DC_DECLSEP
+	int len DC_DECLSEP
+	int frac_len DC_DECLEND
+{
+	bc_num	base;
+	bc_num	result;
+	bc_num	build;
+	bc_num	tmp;
+	bc_num	divisor;
+	int		digit;
+	int		i;
+
+	bc_init_num(&tmp);
+	bc_init_num(&base);
+	bc_int2num(&base, ibase);
+	result = bc_copy_num(_zero_);
+	build = bc_copy_num(_zero_);
+	divisor = bc_copy_num(_one_);
+	for (i = 0; i < len; ++i){
+		digit = getnum_digits[i];
+		digit = isdigit(digit) ? digit - '0' : digit - 'a' + 10;
+		bc_int2num(&tmp, digit);
+		if (i < len - frac_len){
+			bc_multiply(result, base, &result, 0);
+			bc_add(result, tmp, &result, 0);
+		}else{
+			bc_multiply(build, base, &build, 0);
+			bc_add(build, tmp, &build, 0);
+			bc_multiply(divisor, base, &divisor, 0);
+		}
+	}
+	if (frac_len > 0){
+		bc_divide(build, divisor, &build, frac_len);
+		bc_add(result, build, &result, 0);
+	}
+	bc_free_num(&tmp);
+	bc_free_num(&build);
+	bc_free_num(&divisor);
+	bc_free_num(&base);
+	return result;
+}
+
 /* get a dc_num from some input stream;
  *  input is a function which knows how to read the desired input stream
  *  ibase is the input base (2<=ibase<=DC_IBASE_MAX)
  *  *readahead will be set to the readahead character consumed while
  *   looking for the end-of-number
- */
-/* For convenience of the caller, package the dc_num
- * into a dc_data result.
+ * The digits are gathered first and converted all at once.
  */
 dc_data
 dc_getnum DC_DECLARG((input, ibase, readahead))
@@ -297,22 +426,15 @@ dc_getnum DC_DECLARG((input, ibase, readahead))
 	int ibase DC_DECLSEP
 	int *readahead DC_DECLEND
 {
-	bc_num	base;
 	bc_num	result;
-	bc_num	build;
-	bc_num	tmp;
-	bc_num	divisor;
 	dc_data	full_result;
 	int		negative = 0;
+	int		in_base = 1;
 	int		digit;
-	int		decimal;
+	int		len = 0;
+	int		int_len;
 	int		c;
 
-	bc_init_num(&tmp);
-	bc_init_num(&build);
-	bc_init_num(&base);
-	result = bc_copy_num(_zero_);
-	bc_int2num(&base, ibase);
 	c = (*input)();
 	while (isspace(c))
 		c = (*input)();
@@ -332,16 +454,12 @@ dc_getnum DC_DECLARG((input, ibase, readahead))
 		else
 			break;
 		c = (*input)();
-		bc_int2num(&tmp, digit);
-		bc_multiply(result, base, &result, 0);
-		bc_add(result, tmp, &result, 0);
+		if (digit >= ibase)
+			in_base = 0;
+		dc_getnum_digit(len++, digit);
 	}
+	int_len = len;
 	if (c == '.'){
-		bc_free_num(&build);
-		bc_free_num(&tmp);
-		divisor = bc_copy_num(_one_);
-		build = bc_copy_num(_zero_);
-		decimal = 0;
 		for (;;){
 			c = (*input)();
 			if (isdigit(c))
@@ -350,22 +468,25 @@ dc_getnum DC_DECLARG((input, ibase, readahead))
 				digit = 10 + c - 'A';
 			else
 				break;
-			bc_int2num(&tmp, digit);
-			bc_multiply(build, base, &build, 0);
-			bc_add(build, tmp, &build, 0);
-			bc_multiply(divisor, base, &divisor, 0);
-			++decimal;
+			if (digit >= ibase)
+				in_base = 0;
+			dc_getnum_digit(len++, digit);
 		}
-		bc_divide(build, divisor, &build, decimal);
-		bc_add(result, build, &result, 0);
 	}
-	/* Final work. */
-	if (negative)
-		bc_sub(_zero_, result, &result, 0);
+	dc_getnum_digit(len, 0);
+	getnum_digits[len] = '\0';
+
+	if (in_base){
+		bc_init_num(&result);
+		bc_digits2num(&result, getnum_digits, int_len, len - int_len,
+					  ibase, negative);
+	}else{
+		result = dc_getnum_slow(ibase, len, len - int_len);
+		/* Final work. */
+		if (negative)
+			bc_sub(_zero_, result, &result, 0);
+	}
 
-	bc_free_num(&tmp);
-	bc_free_num(&build);
-	bc_free_num(&base);
 	if (readahead)
 		*readahead = c;
 	*CastNumPtr(&full_result.v.number) = result;
@@ -373,7 +494,7 @@ dc_getnum DC_DECLARG((input, ibase, readahead))
 	return full_result;
 }
 
-
+
 /* Return the "length" of the number, ignoring *all* leading zeros,
  * (including those to the right of the radix point!)
  */
@@ -414,6 +535,33 @@ dc_math_init DC_DECLVOID()
 	bc_init_numbers();
 }
 
+/* limit the bytes held by numbers; 0 is no limit */
+void
+dc_mem_limit DC_DECLARG((limit))
+	size_t limit DC_DECLEND
+{
+	bc_mem_limit = limit;
+}
+
+/* has the limit been passed since it was last reported? */
+int
+dc_mem_exceeded DC_DECLVOID()
+{
+	return bc_mem_exceeded;
+}
+
+/* report a passed limit, so that the next command may run */
+void
+dc_mem_report DC_DECLVOID()
+{
+	if (bc_mem_exceeded){
+		fprintf(stderr, "%s: memory limit of %lu bytes exceeded\n",
+				progname, (unsigned long) bc_mem_limit);
+		bc_mem_exceeded = 0;
+		bc_cancel = 0;
+	}
+}
+
 /* print out a dc_num in output base obase to stdout;
  * if discard_p is DC_TOSS then deallocate the value after use
  */
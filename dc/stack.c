@@ -227,6 +227,96 @@ dc_triop DC_DECLARG((op, kscale))
 }
 
 
+/* check that *itemp is a count n followed by n numbers; set *count
+ * to n and move *itemp past them
+ */
+static int
+dc_hyper_group DC_DECLARG((itemp, count))
+	dc_list **itemp DC_DECLSEP
+	int *count DC_DECLEND
+{
+	dc_list *item = *itemp;
+	int i;
+
+	if (item == NULL){
+		Empty_Stack;
+		return DC_FAIL;
+	}
+	if (item->value.dc_type!=DC_NUMBER
+			|| (*count = dc_num2int(item->value.v.number, DC_KEEP)) < 0){
+		fprintf(stderr,
+				"%s: parameter count must be a nonnegative integer\n",
+				progname);
+		return DC_FAIL;
+	}
+	for (i=0; i<*count; ++i){
+		item = item->link;
+		if (item == NULL){
+			Empty_Stack;
+			return DC_FAIL;
+		}
+		if (item->value.dc_type!=DC_NUMBER){
+			fprintf(stderr, "%s: non-numeric value\n", progname);
+			return DC_FAIL;
+		}
+	}
+	*itemp = item->link;
+	return DC_SUCCESS;
+}
+
+/* check that the stack holds  a1 ... ap p b1 ... bq q z  with z on
+ * top, all numbers, then replace them with the hypergeometric series
+ * pFq(a1..ap; b1..bq; z).
+ * If anything is wrong, leave the stack unmodified.
+ */
+void
+dc_hyperop DC_DECLARG((kscale))
+	int kscale DC_DECLEND
+{
+	dc_list *item;
+	dc_data datum;
+	dc_data r;
+	dc_num *a;
+	dc_num *b;
+	int p;
+	int q;
+	int i;
+
+	if (dc_stack == NULL){
+		Empty_Stack;
+		return;
+	}
+	if (dc_stack->value.dc_type!=DC_NUMBER){
+		fprintf(stderr, "%s: non-numeric value\n", progname);
+		return;
+	}
+	item = dc_stack->link;
+	if (dc_hyper_group(&item, &q) != DC_SUCCESS
+			|| dc_hyper_group(&item, &p) != DC_SUCCESS)
+		return;
+
+	a = dc_malloc((p+1) * sizeof *a);
+	b = dc_malloc((q+1) * sizeof *b);
+	item = dc_stack->link->link;
+	for (i=q-1; i>=0; --i, item=item->link)
+		b[i] = item->value.v.number;
+	item = item->link;
+	for (i=p-1; i>=0; --i, item=item->link)
+		a[i] = item->value.v.number;
+	if (dc_hypergeometric(a, p, b, q, dc_stack->value.v.number,
+						  kscale, &r.v.number) == DC_SUCCESS){
+		for (i=p+q+3; i>0; --i){
+			(void)dc_pop(&datum);
+			dc_free_num(&datum.v.number);
+		}
+		r.dc_type = DC_NUMBER;
+		dc_push(r);
+	}
+	free(a);
+	free(b);
+}
+
+
 /* initialize the register stacks to their initial values */
 void
 dc_register_init DC_DECLVOID()
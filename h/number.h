@@ -62,6 +62,13 @@ typedef struct bc_struct
 #define LONG_MAX 0x7fffffff
 #endif
 
+/* The constants known to bc_constant. */
+#define BC_PI	0
+#define BC_LN2	1
+#define BC_LN10	2
+#define BC_E	3
+#define BC_NUM_CONSTANTS 4
+
 
 /* Global numbers. */
 extern bc_num _zero_;
@@ -85,6 +92,18 @@ void bc_str2num (bc_num *num, char *str, int scale);
 
 char *bc_num2str (bc_num num);
 
+/* A buffer size for bc_num2dec that holds most numbers. */
+#define BC_DEC_BUF 128
+
+int bc_num2dec_size (bc_num num);
+
+int bc_num2dec (bc_num num, char *str, int size);
+
+int bc_set_decimal (mpz_t value, char *digits, int len);
+
+void bc_digits2num (bc_num *num, char *digits, int int_len, int frac_len,
+		    int base, int negative);
+
 void bc_int2num (bc_num *num, int val);
 
 long bc_num2long (bc_num num);
@@ -108,6 +127,8 @@ void bc_multiply (bc_num n1, bc_num n2, bc_num *prod, int scale);
 
 int bc_divide (bc_num n1, bc_num n2, bc_num *quot, int scale);
 
+int bc_divide_ui (bc_num n1, unsigned long divisor, bc_num *quot, int scale);
+
 int bc_modulo (bc_num num1, bc_num num2, bc_num *result, int scale);
 
 int bc_divmod (bc_num num1, bc_num num2, bc_num *quot,
@@ -121,8 +142,77 @@ void bc_raise (bc_num num1, bc_num num2, bc_num *result,
 
 int bc_sqrt (bc_num *num, int scale);
 
+void bc_factorial (unsigned long n, bc_num *result);
+
+void bc_binomial (bc_num n, unsigned long k, bc_num *result);
+
+void bc_fibonacci (unsigned long n, bc_num *result);
+
+void bc_lucas (unsigned long n, bc_num *result);
+
+int bc_isprime (bc_num num, int reps);
+
+void bc_nextprime (bc_num num, bc_num *result);
+
+void bc_gcd (bc_num n1, bc_num n2, bc_num *result);
+
+void bc_lcm (bc_num n1, bc_num n2, bc_num *result);
+
+int bc_modinv (bc_num num, bc_num mod, bc_num *result);
+
+int bc_jacobi (bc_num n1, bc_num n2);
+
+int bc_logic (int op, bc_num n1, bc_num n2, bc_num *result);
+
+int bc_shift (bc_num num, long bits, bc_num *result);
+
+long bc_popcount (bc_num num);
+
+long bc_bitlen (bc_num num);
+
+int bc_iroot (bc_num num, unsigned long n, bc_num *result);
+
+void bc_srandom (bc_num seed);
+
+int bc_random (bc_num bound, int scale, bc_num *result);
+
+int bc_constant (int which, int scale, bc_num *result);
+
 void bc_out_num (bc_num num, int o_base, void (* out_char)(int),
 			     int leading_zero);
 
 void bc_out_long (long val, int size, int space, void (*out_char)(int));
+
+#ifdef BC_STATS
+/* The numbers made, and those taken from the free list, for --stats. */
+extern unsigned long bc_stats_new, bc_stats_reused;
+#endif
+
+/* The bytes of number storage in use, the most there have been, and
+   the limit past which bc_mem_exceeded is set.  0 is no limit. */
+extern size_t bc_mem_bytes, bc_mem_peak, bc_mem_limit;
+extern volatile int bc_mem_exceeded;
+
+/* Set, from a signal handler or another thread, to stop the long
+   operations between their steps.  Their results are then not valid. */
+extern volatile int bc_cancel;
+
+/* From bsplit.c */
+
+void bc_bsplit_constant (int which, int digits, mpz_t value);
+
+int bc_hypergeometric (bc_num *a, int p, bc_num *b, int q, bc_num z,
+		       int scale, bc_num *result);
+
+/* From float.c */
+
+#ifdef HAVE_MPFR
+#include <mpfr.h>
+
+/* An MPFR function of one value, such as mpfr_exp. */
+typedef int (*bc_mpfr_func) (mpfr_ptr, mpfr_srcptr, mpfr_rnd_t);
+
+int bc_float (bc_mpfr_func func, bc_num x, int scale, bc_num *result);
+#endif
+
 #endif
@@ -0,0 +1,887 @@
+/* bsplit.c: Series evaluation by binary splitting. */
+/*
+    Copyright (C) 2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, write to:
+
+      The Free Software Foundation, Inc.
+      51 Franklin Street, Fifth Floor
+      Boston, MA 02110-1301  USA
+
+
+    A series whose terms have rational ratios can be summed exactly
+    over its first N terms as one fraction T/Q.  Binary splitting
+    builds that fraction as a tree: the terms A to B-1 are split in
+    the middle, each half is done alone and the two are joined with a
+    few multiplies.  The numbers in a subtree only grow as big as the
+    subtree, so most of the work is multiplying numbers of about the
+    same size, which GMP does fast.  The two halves of every split do
+    not depend on each other, so large trees are shared out over a
+    pool of threads.
+
+    The threads only use mpz_t values.  The bc_num routines keep a
+    free list that is not safe to use from more than one thread.
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <config.h>
+#include <number.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <math.h>
+#include <pthread.h>
+
+void *bc_num_malloc (size_t);
+void *bc_num_realloc (void *, size_t, size_t);
+
+/* A series to sum.  The sum is
+     a(0) + a(1)*p(1)/q(1) + a(2)*p(1)*p(2)/(q(1)*q(2)) + ...
+   LEAF sets P to p(k), Q to q(k) and T to a(k)*p(k) for term K, with
+   p(0) and q(0) being 1.  LEAF is called from many threads at once,
+   so it may only read DATA. */
+
+typedef struct {
+      void (*leaf) (unsigned long k, mpz_t p, mpz_t q, mpz_t t,
+		    const void *data);
+      const void *data;
+    } bs_series;
+
+/* Work for a thread.  Either the P, Q and T of the terms A to B-1 of
+   SERIES, or the product R = X * Y. */
+
+typedef struct bs_task {
+      const bs_series *series;	/* NULL for a product. */
+      unsigned long a, b;
+      int need_p;		/* P is wanted, not just Q and T. */
+      mpz_t p, q, t;
+      mpz_ptr r, x, y;
+      int done;			/* Set with bs_lock held. */
+    } bs_task;
+
+/* A thread's own tasks.  The thread takes the newest, the others
+   steal the oldest, which are the largest. */
+
+typedef struct {
+      bs_task **tasks;
+      int count, size;
+    } bs_deque;
+
+/* The thread pool.  Thread 0 is the caller. */
+static int bs_threads = 0;	/* 0 until the pool is started. */
+static bs_deque *bs_deques;
+static pthread_mutex_t bs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bs_change = PTHREAD_COND_INITIALIZER;
+
+/* Ranges of terms up to this long are done by one thread. */
+static unsigned long bs_grain;
+
+/* Sums shorter than this do not use the pool. */
+#define BS_PARALLEL_TERMS 1000
+
+/* The most threads used. */
+#define BS_MAX_THREADS 256
+
+/* Extra digits for deciding how many terms of a series are needed. */
+#define BS_GUARD 4
+
+static void bs_run (int self, bs_task *task);
+
+
+/* A cancelled sum is not used, but it must not divide by zero.  It is
+   given P = 1, Q = 1 and T = 0, and the big products are skipped. */
+
+static void
+bs_cancelled (mpz_t p, mpz_t q, mpz_t t)
+{
+  mpz_set_ui (p, 1);
+  mpz_set_ui (q, 1);
+  mpz_set_ui (t, 0);
+}
+
+/* Sum terms A to B-1 of SERIES in this thread. */
+
+static void
+bs_serial (const bs_series *series, unsigned long a, unsigned long b,
+	   int need_p, mpz_t p, mpz_t q, mpz_t t)
+{
+  unsigned long m;
+  mpz_t p2, q2, t2;
+
+  if (bc_cancel)
+    {
+      bs_cancelled (p, q, t);
+      return;
+    }
+
+  if (b - a == 1)
+    {
+      series->leaf (a, p, q, t, series->data);
+      return;
+    }
+
+  m = a + (b - a) / 2;
+  mpz_init (p2);
+  mpz_init (q2);
+  mpz_init (t2);
+  bs_serial (series, a, m, TRUE, p, q, t);
+  bs_serial (series, m, b, need_p, p2, q2, t2);
+
+  /* T = T1*Q2 + P1*T2, Q = Q1*Q2, P = P1*P2 */
+  if (bc_cancel)
+    bs_cancelled (p, q, t);
+  else
+    {
+      mpz_mul (t, t, q2);
+      mpz_addmul (t, p, t2);
+      mpz_mul (q, q, q2);
+      if (need_p)
+	mpz_mul (p, p, p2);
+    }
+
+  mpz_clear (p2);
+  mpz_clear (q2);
+  mpz_clear (t2);
+}
+
+
+/* The deque routines are called with bs_lock held. */
+
+static void
+bs_push (int self, bs_task *task)
+{
+  bs_deque *dq = &bs_deques[self];
+
+  if (dq->count == dq->size)
+    {
+      dq->size = dq->size * 2 + 16;
+      dq->tasks = bc_num_realloc (dq->tasks, 0,
+				  dq->size * sizeof (bs_task *));
+    }
+  dq->tasks[dq->count++] = task;
+  pthread_cond_broadcast (&bs_change);
+}
+
+/* Take a task from another thread, or NULL if there is none. */
+
+static bs_task *
+bs_steal (int self)
+{
+  bs_deque *dq;
+  bs_task *task;
+  int ix;
+
+  for (ix = 1; ix < bs_threads; ix++)
+    {
+      dq = &bs_deques[(self + ix) % bs_threads];
+      if (dq->count > 0)
+	{
+	  task = dq->tasks[0];
+	  dq->count--;
+	  memmove (dq->tasks, dq->tasks + 1, dq->count * sizeof (bs_task *));
+	  return task;
+	}
+    }
+  return NULL;
+}
+
+
+/* Wait for TASK, which was pushed by this thread, to be done.  If no
+   other thread has taken it, do it here.  Otherwise help with other
+   work until it is done. */
+
+static void
+bs_join (int self, bs_task *task)
+{
+  bs_deque *dq = &bs_deques[self];
+  bs_task *other;
+
+  pthread_mutex_lock (&bs_lock);
+  while (!task->done)
+    {
+      if (dq->count > 0 && dq->tasks[dq->count-1] == task)
+	{
+	  dq->count--;
+	  pthread_mutex_unlock (&bs_lock);
+	  bs_run (self, task);
+	  pthread_mutex_lock (&bs_lock);
+	}
+      else if ((other = bs_steal (self)) != NULL)
+	{
+	  pthread_mutex_unlock (&bs_lock);
+	  bs_run (self, other);
+	  pthread_mutex_lock (&bs_lock);
+	}
+      else
+	pthread_cond_wait (&bs_change, &bs_lock);
+    }
+  pthread_mutex_unlock (&bs_lock);
+}
+
+
+/* Set up TASK to compute R = X * Y. */
+
+static void
+bs_product (bs_task *task, mpz_ptr r, mpz_ptr x, mpz_ptr y)
+{
+  task->series = NULL;
+  task->r = r;
+  task->x = x;
+  task->y = y;
+  task->done = FALSE;
+}
+
+/* Set up TASK for the terms A to B-1 of SERIES. */
+
+static void
+bs_range (bs_task *task, const bs_series *series, unsigned long a,
+	  unsigned long b, int need_p)
+{
+  task->series = series;
+  task->a = a;
+  task->b = b;
+  task->need_p = need_p;
+  mpz_init (task->p);
+  mpz_init (task->q);
+  mpz_init (task->t);
+  task->done = FALSE;
+}
+
+
+/* Do TASK in thread SELF.  Large ranges are split, and the half that
+   is not done here right away is left for other threads to steal. */
+
+static void
+bs_run (int self, bs_task *task)
+{
+  bs_task left, right, prod[2];
+  unsigned long m;
+  mpz_t temp;
+
+  if (task->series == NULL)
+    mpz_mul (task->r, task->x, task->y);
+  else if (task->b - task->a <= bs_grain)
+    bs_serial (task->series, task->a, task->b, task->need_p,
+	       task->p, task->q, task->t);
+  else
+    {
+      m = task->a + (task->b - task->a) / 2;
+      bs_range (&left, task->series, task->a, m, TRUE);
+      bs_range (&right, task->series, m, task->b, task->need_p);
+      pthread_mutex_lock (&bs_lock);
+      bs_push (self, &right);
+      pthread_mutex_unlock (&bs_lock);
+      bs_run (self, &left);
+      bs_join (self, &right);
+
+      if (bc_cancel)
+	bs_cancelled (task->p, task->q, task->t);
+      else
+	{
+	  /* The products of the join are big and do not depend on
+	     each other, so they are shared out as well. */
+	  mpz_init (temp);
+	  bs_product (&prod[0], task->q, left.q, right.q);
+	  bs_product (&prod[1], task->t, left.t, right.q);
+	  pthread_mutex_lock (&bs_lock);
+	  bs_push (self, &prod[0]);
+	  bs_push (self, &prod[1]);
+	  pthread_mutex_unlock (&bs_lock);
+	  mpz_mul (temp, left.p, right.t);
+	  if (task->need_p)
+	    mpz_mul (task->p, left.p, right.p);
+	  bs_join (self, &prod[1]);
+	  bs_join (self, &prod[0]);
+	  mpz_add (task->t, task->t, temp);
+	  mpz_clear (temp);
+	}
+
+      mpz_clear (left.p);
+      mpz_clear (left.q);
+      mpz_clear (left.t);
+      mpz_clear (right.p);
+      mpz_clear (right.q);
+      mpz_clear (right.t);
+    }
+
+  pthread_mutex_lock (&bs_lock);
+  task->done = TRUE;
+  pthread_cond_broadcast (&bs_change);
+  pthread_mutex_unlock (&bs_lock);
+}
+
+
+/* The loop of a pool thread. */
+
+static void *
+bs_worker (void *arg)
+{
+  int self = (int) (long) arg;
+  bs_task *task;
+
+  pthread_mutex_lock (&bs_lock);
+  for (;;)
+    {
+      task = bs_steal (self);
+      if (task != NULL)
+	{
+	  pthread_mutex_unlock (&bs_lock);
+	  bs_run (self, task);
+	  pthread_mutex_lock (&bs_lock);
+	}
+      else
+	pthread_cond_wait (&bs_change, &bs_lock);
+    }
+  /*NOTREACHED*/
+  return NULL;
+}
+
+
+/* Start the pool, if it is not running, and return the number of
+   threads.  BC_THREADS in the environment sets the number, otherwise
+   one thread is used for each processor. */
+
+static int
+bs_start_pool (void)
+{
+  pthread_t thread;
+  pthread_attr_t attr;
+  const char *env;
+  long count;
+
+  if (bs_threads != 0)
+    return bs_threads;
+
+  env = getenv ("BC_THREADS");
+  if (env != NULL)
+    count = atol (env);
+  else
+    {
+#ifdef _SC_NPROCESSORS_ONLN
+      count = sysconf (_SC_NPROCESSORS_ONLN);
+#else
+      count = 1;
+#endif
+    }
+  if (count < 1) count = 1;
+  if (count > BS_MAX_THREADS) count = BS_MAX_THREADS;
+
+  bs_deques = bc_num_malloc (count * sizeof (bs_deque));
+  memset (bs_deques, 0, count * sizeof (bs_deque));
+
+  pthread_attr_init (&attr);
+  pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+  for (bs_threads = 1; bs_threads < count; bs_threads++)
+    if (pthread_create (&thread, &attr, bs_worker,
+			(void *) (long) bs_threads) != 0)
+      break;
+  pthread_attr_destroy (&attr);
+
+  return bs_threads;
+}
+
+
+/* Sum the first N terms of SERIES as T/Q. */
+
+static void
+bs_sum (const bs_series *series, unsigned long n, mpz_t q, mpz_t t)
+{
+  bs_task top;
+  int threads;
+
+  if (n < BS_PARALLEL_TERMS || (threads = bs_start_pool ()) < 2)
+    {
+      mpz_t p;
+
+      mpz_init (p);
+      bs_serial (series, 0, n, FALSE, p, q, t);
+      mpz_clear (p);
+      return;
+    }
+
+  /* Enough pieces that the threads stay busy when some are slow. */
+  bs_grain = n / (threads * 8);
+  if (bs_grain < 16) bs_grain = 16;
+
+  bs_range (&top, series, 0, n, FALSE);
+  bs_run (0, &top);
+  mpz_swap (q, top.q);
+  mpz_swap (t, top.t);
+  mpz_clear (top.p);
+  mpz_clear (top.q);
+  mpz_clear (top.t);
+}
+
+
+/* The series for the constants. */
+
+/* Chudnovsky:
+     426880*sqrt(10005)/pi = sum (6k)!*(13591409+545140134*k)
+				 / ((3k)!*(k!)^3*(-640320)^(3k)) */
+
+static void
+leaf_pi (unsigned long k, mpz_t p, mpz_t q, mpz_t t, const void *data)
+{
+  if (k == 0)
+    {
+      mpz_set_ui (p, 1);
+      mpz_set_ui (q, 1);
+      mpz_set_ui (t, 13591409);
+      return;
+    }
+
+  /* p(k) = -(6k-5)*(2k-1)*(6k-1), q(k) = k^3*640320^3/24 */
+  mpz_set_ui (p, 6*k - 5);
+  mpz_mul_ui (p, p, 2*k - 1);
+  mpz_mul_ui (p, p, 6*k - 1);
+  mpz_neg (p, p);
+  mpz_set_ui (q, k);
+  mpz_mul_ui (q, q, k);
+  mpz_mul_ui (q, q, k);
+  mpz_mul_ui (q, q, 640320 / 24);
+  mpz_mul_ui (q, q, 640320);
+  mpz_mul_ui (q, q, 640320);
+
+  /* t(k) = p(k)*(13591409+545140134*k) */
+  mpz_set_ui (t, 545140134);
+  mpz_mul_ui (t, t, k);
+  mpz_add_ui (t, t, 13591409);
+  mpz_mul (t, t, p);
+}
+
+/* e = sum 1/k! */
+
+static void
+leaf_e (unsigned long k, mpz_t p, mpz_t q, mpz_t t, const void *data)
+{
+  mpz_set_ui (p, 1);
+  mpz_set_ui (q, k == 0 ? 1 : k);
+  mpz_set_ui (t, 1);
+}
+
+/* atanh(1/x)*x = sum 1/((2k+1)*x^(2k)), with DATA pointing at x.
+   The ratio of term k to term k-1 is (2k-1)/((2k+1)*x^2). */
+
+static void
+leaf_atanh (unsigned long k, mpz_t p, mpz_t q, mpz_t t, const void *data)
+{
+  unsigned long x = *(const unsigned long *) data;
+
+  if (k == 0)
+    {
+      mpz_set_ui (p, 1);
+      mpz_set_ui (q, 1);
+    }
+  else
+    {
+      mpz_set_ui (p, 2*k - 1);
+      mpz_set_ui (q, 2*k + 1);
+      mpz_mul_ui (q, q, x);
+      mpz_mul_ui (q, q, x);
+    }
+  mpz_set (t, p);
+}
+
+/* SUM += MULT * ONE * atanh(1/X) for a fixed point ONE with DIGITS
+   digits. */
+
+static void
+bs_atanh (mpz_t sum, long mult, unsigned long x, mpz_t one, int digits)
+{
+  bs_series series;
+  mpz_t q, t;
+
+  series.leaf = leaf_atanh;
+  series.data = &x;
+  mpz_init (q);
+  mpz_init (t);
+  bs_sum (&series, (unsigned long) (digits / (2 * log10 ((double) x))) + 2,
+	  q, t);
+  if (!bc_cancel)
+    {
+      mpz_mul (t, t, one);
+      mpz_mul_ui (q, q, x);
+      mpz_tdiv_q (t, t, q);
+      if (mult < 0)
+	mpz_submul_ui (sum, t, -mult);
+      else
+	mpz_addmul_ui (sum, t, mult);
+    }
+  mpz_clear (q);
+  mpz_clear (t);
+}
+
+
+/* Compute constant WHICH (BC_PI, BC_LN2, BC_LN10 or BC_E) times 10 to
+   the DIGITS into VALUE.  The last few digits may be wrong, so the
+   caller should ask for some more than it needs.  If bc_cancel is set
+   VALUE is not valid. */
+
+void
+bc_bsplit_constant (int which, int digits, mpz_t value)
+{
+  bs_series series;
+  mpz_t one, q, t;
+  unsigned long n;
+  double size;
+
+  mpz_init (one);
+  mpz_ui_pow_ui (one, 10, digits);
+  mpz_init (q);
+  mpz_init (t);
+  mpz_set_ui (value, 0);
+
+  switch (which)
+    {
+    case BC_PI:
+      /* Each term gives a little over 14 digits. */
+      series.leaf = leaf_pi;
+      series.data = NULL;
+      bs_sum (&series, (unsigned long) (digits / 14.18) + 2, q, t);
+      if (bc_cancel || mpz_sgn (t) == 0)
+	break;
+
+      /* pi = 426880*sqrt(10005)*Q/T */
+      mpz_mul (value, one, one);
+      mpz_mul_ui (value, value, 10005);
+      mpz_sqrt (value, value);
+      mpz_mul_ui (value, value, 426880);
+      mpz_mul (value, value, q);
+      mpz_tdiv_q (value, value, t);
+      break;
+
+    case BC_LN2:
+      /* ln(2) = 14*atanh(1/31) + 10*atanh(1/49) + 6*atanh(1/161) */
+      bs_atanh (value, 14, 31, one, digits);
+      bs_atanh (value, 10, 49, one, digits);
+      bs_atanh (value, 6, 161, one, digits);
+      break;
+
+    case BC_LN10:
+      /* ln(10) = ln(2) + ln(5)
+	        = 46*atanh(1/31) + 34*atanh(1/49) + 20*atanh(1/161) */
+      bs_atanh (value, 46, 31, one, digits);
+      bs_atanh (value, 34, 49, one, digits);
+      bs_atanh (value, 20, 161, one, digits);
+      break;
+
+    case BC_E:
+      /* Enough terms that n! is more than 10^digits. */
+      size = 0;
+      for (n = 1; size <= digits + 1; n++)
+	size += log10 ((double) n);
+      series.leaf = leaf_e;
+      series.data = NULL;
+      bs_sum (&series, n, q, t);
+      if (bc_cancel)
+	break;
+      mpz_mul (value, t, one);
+      mpz_tdiv_q (value, value, q);
+      break;
+    }
+
+  mpz_clear (one);
+  mpz_clear (q);
+  mpz_clear (t);
+}
+
+
+/* Generalized hypergeometric series:
+     pFq(a1..ap; b1..bq; z) = sum (a1)_k...(ap)_k / ((b1)_k...(bq)_k)
+				  * z^k/k!
+   where (x)_k = x*(x+1)*...*(x+k-1).  A bc number is an integer over
+   a power of ten, so every ratio of terms is a ratio of integers:
+     p(k) = pc * prod (A_i + (k-1)*AD_i)
+     q(k) = qc * k * prod (B_j + (k-1)*BD_j)
+   with pc = prod BD_j * Z and qc = prod AD_i * ZD. */
+
+typedef struct {
+      int p, q;
+      mpz_t *an, *ad;	/* a_i = an[i]/ad[i] */
+      mpz_t *bn, *bd;	/* b_j = bn[j]/bd[j] */
+      mpz_t pc, qc;
+    } hyper_data;
+
+static void
+leaf_hyper (unsigned long k, mpz_t p, mpz_t q, mpz_t t, const void *data)
+{
+  const hyper_data *hd = data;
+  mpz_t temp;
+  int ix;
+
+  if (k == 0)
+    {
+      mpz_set_ui (p, 1);
+      mpz_set_ui (q, 1);
+      mpz_set_ui (t, 1);
+      return;
+    }
+
+  mpz_init (temp);
+  mpz_set (p, hd->pc);
+  for (ix = 0; ix < hd->p; ix++)
+    {
+      mpz_set (temp, hd->an[ix]);
+      mpz_addmul_ui (temp, hd->ad[ix], k - 1);
+      mpz_mul (p, p, temp);
+    }
+  mpz_mul_ui (q, hd->qc, k);
+  for (ix = 0; ix < hd->q; ix++)
+    {
+      mpz_set (temp, hd->bn[ix]);
+      mpz_addmul_ui (temp, hd->bd[ix], k - 1);
+      mpz_mul (q, q, temp);
+    }
+  mpz_set (t, p);
+  mpz_clear (temp);
+}
+
+/* Set N and D so that NUM = N/D. */
+
+static void
+bs_fraction (bc_num num, mpz_t n, mpz_t d)
+{
+  mpz_init_set (n, num->n_value);
+  mpz_init (d);
+  mpz_ui_pow_ui (d, 10, num->n_scale);
+}
+
+/* If N/D is an integer that is zero or less, return -(N/D), else -1. */
+
+static long
+bs_nonpositive (mpz_t n, mpz_t d)
+{
+  mpz_t whole;
+  long val;
+
+  if (mpz_sgn (n) > 0 || !mpz_divisible_p (n, d))
+    return -1;
+  mpz_init (whole);
+  mpz_divexact (whole, n, d);
+  val = mpz_fits_slong_p (whole) ? -mpz_get_si (whole) : LONG_MAX;
+  mpz_clear (whole);
+  return val;
+}
+
+/* N/D as a double. */
+
+static double
+bs_get_d (mpz_t n, mpz_t d)
+{
+  long ne, de;
+  double nm, dm;
+
+  nm = mpz_get_d_2exp (&ne, n);
+  dm = mpz_get_d_2exp (&de, d);
+  return ldexp (nm / dm, ne - de);
+}
+
+/* The natural logarithm of |N/D|, which is not zero. */
+
+static double
+bs_log (mpz_t n, mpz_t d)
+{
+  long ne, de;
+  double nm, dm;
+
+  nm = mpz_get_d_2exp (&ne, n);
+  dm = mpz_get_d_2exp (&de, d);
+  return log (fabs (nm / dm)) + (ne - de) * M_LN2;
+}
+
+/* The most terms of a hypergeometric series that will be summed. */
+#define BS_MAX_TERMS 100000000UL
+
+/* Place pFq(A[0..P-1]; B[0..Q-1]; Z) with SCALE digits after the
+   decimal point in RESULT.  Returns 0 if all is well, -1 if some b is
+   an integer that is zero or less, -2 if the series does not converge
+   and -3 if bc_cancel stopped the sum.  RESULT is only set for 0. */
+
+int
+bc_hypergeometric (bc_num *a, int p, bc_num *b, int q, bc_num z,
+		   int scale, bc_num *result)
+{
+  hyper_data hd;
+  bs_series series;
+  double *av, *bv, need, lt, lr, lz, ratio, zabs, kmin;
+  unsigned long n, stop, k;
+  long pole;
+  mpz_t zn, zd, sq, st, gcd;
+  bc_num value;
+  int ix, status;
+
+  /* The parameters as fractions. */
+  hd.p = p;
+  hd.q = q;
+  hd.an = bc_num_malloc ((p + 1) * sizeof (mpz_t));
+  hd.ad = bc_num_malloc ((p + 1) * sizeof (mpz_t));
+  hd.bn = bc_num_malloc ((q + 1) * sizeof (mpz_t));
+  hd.bd = bc_num_malloc ((q + 1) * sizeof (mpz_t));
+  av = bc_num_malloc ((p + 1) * sizeof (double));
+  bv = bc_num_malloc ((q + 1) * sizeof (double));
+  mpz_init (hd.pc);
+  mpz_init (hd.qc);
+  bs_fraction (z, zn, zd);
+  mpz_set (hd.pc, zn);
+  mpz_set (hd.qc, zd);
+  for (ix = 0; ix < p; ix++)
+    {
+      bs_fraction (a[ix], hd.an[ix], hd.ad[ix]);
+      mpz_mul (hd.qc, hd.qc, hd.ad[ix]);
+      av[ix] = bs_get_d (hd.an[ix], hd.ad[ix]);
+    }
+  for (ix = 0; ix < q; ix++)
+    {
+      bs_fraction (b[ix], hd.bn[ix], hd.bd[ix]);
+      mpz_mul (hd.pc, hd.pc, hd.bd[ix]);
+      bv[ix] = bs_get_d (hd.bn[ix], hd.bd[ix]);
+    }
+
+  /* Keep the constant factors small. */
+  mpz_init (gcd);
+  mpz_gcd (gcd, hd.pc, hd.qc);
+  mpz_divexact (hd.pc, hd.pc, gcd);
+  mpz_divexact (hd.qc, hd.qc, gcd);
+  mpz_clear (gcd);
+
+  /* A zero or negative integer a makes the series a polynomial. */
+  stop = BS_MAX_TERMS + 1;
+  for (ix = 0; ix < p; ix++)
+    {
+      pole = bs_nonpositive (hd.an[ix], hd.ad[ix]);
+      if (pole >= 0 && (unsigned long) pole < stop)
+	stop = pole + 1;
+    }
+
+  /* A zero or negative integer b divides by zero. */
+  status = 0;
+  for (ix = 0; ix < q; ix++)
+    {
+      pole = bs_nonpositive (hd.bn[ix], hd.bd[ix]);
+      if (pole >= 0 && (unsigned long) pole + 1 < stop)
+	status = -1;
+    }
+
+  /* Find how many terms are needed.  Keep the log of the size of
+     term k in LT until the rest of the terms add up to less than the
+     last digit.  Once k is past all negative parameters, the ratio of
+     the terms moves towards its limit, |z| if p = q+1, or 0 if less,
+     so the rest of the terms are less than a geometric series. */
+  n = 1;
+  if (status == 0 && !bc_is_zero (z))
+    {
+      lz = bs_log (zn, zd);
+      if (stop > BS_MAX_TERMS && (p > q+1 || (p == q+1 && lz >= 0)))
+	status = -2;
+      kmin = 0;
+      for (ix = 0; ix < p; ix++)
+	if (-av[ix] > kmin) kmin = -av[ix];
+      for (ix = 0; ix < q; ix++)
+	if (-bv[ix] > kmin) kmin = -bv[ix];
+      zabs = (p == q+1 ? exp (lz) : 0);
+      need = -(scale + BS_GUARD) * M_LN10;
+      lt = 0;
+      for (k = 0; status == 0; k++)
+	{
+	  if (k + 1 >= stop)
+	    {
+	      n = stop;
+	      break;
+	    }
+	  if (k >= BS_MAX_TERMS)
+	    {
+	      status = -2;
+	      break;
+	    }
+	  lr = lz - log ((double) k + 1);
+	  for (ix = 0; ix < p; ix++)
+	    lr += log (fabs (av[ix] + k));
+	  for (ix = 0; ix < q; ix++)
+	    lr -= log (fabs (bv[ix] + k));
+	  ratio = exp (lr);
+	  if (ratio < zabs)
+	    ratio = zabs;
+	  if (k > kmin && lt < need && ratio < 1
+	      && lt - log1p (-ratio) < need)
+	    {
+	      n = (k > 0 ? k : 1);
+	      break;
+	    }
+	  lt += lr;
+	}
+    }
+
+  /* Sum the series. */
+  if (status == 0)
+    {
+      series.leaf = leaf_hyper;
+      series.data = &hd;
+      mpz_init (sq);
+      mpz_init (st);
+      bs_sum (&series, n, sq, st);
+      if (bc_cancel)
+	status = -3;
+      else
+	{
+	  /* The sum is carried to BS_GUARD more digits, where it is off
+	     by less than one for the terms left out and one for the
+	     division.  Moving it two away from zero there before the
+	     guard digits are dropped keeps a value that ends exactly,
+	     like 2 for 1F0(1;;0.5), from losing its last digit. */
+	  value = bc_new_num (1, scale);
+	  mpz_ui_pow_ui (value->n_value, 10, scale + BS_GUARD);
+	  mpz_mul (value->n_value, value->n_value, st);
+	  mpz_tdiv_q (value->n_value, value->n_value, sq);
+	  if (mpz_sgn (value->n_value) < 0)
+	    mpz_sub_ui (value->n_value, value->n_value, 2);
+	  else
+	    mpz_add_ui (value->n_value, value->n_value, 2);
+	  mpz_ui_pow_ui (sq, 10, BS_GUARD);
+	  mpz_tdiv_q (value->n_value, value->n_value, sq);
+	  bc_free_num (result);
+	  *result = value;
+	}
+      mpz_clear (sq);
+      mpz_clear (st);
+    }
+
+  for (ix = 0; ix < p; ix++)
+    {
+      mpz_clear (hd.an[ix]);
+      mpz_clear (hd.ad[ix]);
+    }
+  for (ix = 0; ix < q; ix++)
+    {
+      mpz_clear (hd.bn[ix]);
+      mpz_clear (hd.bd[ix]);
+    }
+  mpz_clear (hd.pc);
+  mpz_clear (hd.qc);
+  mpz_clear (zn);
+  mpz_clear (zd);
+  free (hd.an);
+  free (hd.ad);
+  free (hd.bn);
+  free (hd.bd);
+  free (av);
+  free (bv);
+  return status;
+}
@@ -0,0 +1,89 @@
+/* float.c: Binary floating point with MPFR. */
+/*
+    Copyright (C) 2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, write to:
+
+      The Free Software Foundation, Inc.
+      51 Franklin Street, Fifth Floor
+      Boston, MA 02110-1301  USA
+
+
+    With --float, bc computes the math library functions in binary
+    floating point with MPFR instead of in decimal.  The numbers are
+    converted to MPFR values for the call and back, and all other
+    arithmetic is still done by number.c.
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <config.h>
+#include <number.h>
+
+#ifdef HAVE_MPFR
+
+/* Place FUNC (X) in RESULT truncated to SCALE digits.  X is converted
+   with the bits of its integer part and PREC more, so a large argument
+   keeps its fraction.  The value is computed correctly rounded to PREC
+   bits, a few digits more than SCALE, and again with the bits of its
+   integer part added if it is large.  Returns -1 if the value is not a
+   finite number. */
+
+int
+bc_float (bc_mpfr_func func, bc_num x, int scale, bc_num *result)
+{
+  mpfr_t fx, fv;
+  mpfr_prec_t prec;
+  mpz_t ten;
+  bc_num temp;
+  int ok;
+
+  prec = (mpfr_prec_t) (scale + 4) * 10 / 3 + 32;
+  mpz_init (ten);
+  mpfr_init2 (fx, (mpfr_prec_t) mpz_sizeinbase (x->n_value, 2) + prec);
+  mpfr_set_z (fx, x->n_value, MPFR_RNDN);
+  if (x->n_scale > 0)
+    {
+      mpz_ui_pow_ui (ten, 10, x->n_scale);
+      mpfr_div_z (fx, fx, ten, MPFR_RNDN);
+    }
+
+  mpfr_init2 (fv, prec);
+  for (;;)
+    {
+      (*func) (fv, fx, MPFR_RNDN);
+      if (!mpfr_regular_p (fv) || mpfr_get_exp (fv) <= 0
+	  || mpfr_get_prec (fv) >= prec + mpfr_get_exp (fv))
+	break;
+      mpfr_set_prec (fv, prec + mpfr_get_exp (fv));
+    }
+
+  ok = mpfr_number_p (fv);
+  if (ok)
+    {
+      mpz_ui_pow_ui (ten, 10, scale);
+      mpfr_mul_z (fv, fv, ten, MPFR_RNDN);
+      temp = bc_new_num (1, scale);
+      mpfr_get_z (temp->n_value, fv, MPFR_RNDZ);
+      bc_free_num (result);
+      *result = temp;
+    }
+
+  mpfr_clear (fx);
+  mpfr_clear (fv);
+  mpz_clear (ten);
+  return ok ? 0 : -1;
+}
+
+#endif
@@ -0,0 +1,407 @@
+/* numbench.c: Time the routines of number.c. */
+/*
+    Copyright (C) 2017 Free Software Foundation, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License , or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; see the file COPYING.  If not, write to:
+
+      The Free Software Foundation, Inc.
+      51 Franklin Street, Fifth Floor
+      Boston, MA 02110-1301  USA
+
+
+    Each operation is timed on operands of 1, 2, 5, 10, 20, 50, ...
+    digits up to the largest size asked for.  An operation is done
+    over and over, twice as many times each round, until a round
+    takes the least time asked for.  That round gives the time, the
+    allocations and the bytes allocated for one operation.  The
+    storage comes from bc_num_malloc and bc_num_realloc, which number.c
+    and GMP use for everything, so they are counted here.  Stack
+    space GMP takes for small temporaries is not seen.
+
+    An operation is not tried on larger operands once one takes more
+    than the limit, so the slow ones do not hold up the rest.
+
+    The output is CSV, one line for each operation and size.
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <config.h>
+#include <number.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <stdarg.h>
+#include <time.h>
+
+/* The allocations and bytes since the counts were cleared. */
+static unsigned long alloc_count;
+static unsigned long alloc_bytes;
+
+/* The operands for the size being timed.  X and Y are integers of
+   DIGITS digits that differ in the last one.  XF has the same digits
+   as X with half of them after the decimal point, YF likewise.  WIDE
+   has twice the digits.  X_TEXT is X as a string.  RESULT gets the
+   result of each operation. */
+static long digits;
+static bc_num x, y, xf, yf, wide;
+static char *x_text;
+static bc_num result;
+
+/* The characters written by bc_out_num. */
+static unsigned long out_count;
+
+
+/* The routines number.c needs from bc. */
+
+void *
+bc_num_malloc (size_t size)
+{
+  void *ptr;
+
+  ptr = malloc (size);
+  if (ptr == NULL)
+    {
+      fprintf (stderr, "numbench: Out of memory for malloc.\n");
+      exit (1);
+    }
+  __sync_fetch_and_add (&alloc_count, 1);
+  __sync_fetch_and_add (&alloc_bytes, size);
+  return ptr;
+}
+
+void *
+bc_num_realloc (void *oldptr, size_t oldsize, size_t newsize)
+{
+  void *ptr;
+
+  ptr = realloc (oldptr, newsize);
+  if (ptr == NULL)
+    {
+      fprintf (stderr, "numbench: Out of memory for realloc.\n");
+      exit (1);
+    }
+  __sync_fetch_and_add (&alloc_count, 1);
+  if (newsize > oldsize)
+    __sync_fetch_and_add (&alloc_bytes, newsize - oldsize);
+  return ptr;
+}
+
+void
+rt_error (const char *mesg, ...)
+{
+  va_list args;
+
+  va_start (args, mesg);
+  fprintf (stderr, "Runtime error: ");
+  vfprintf (stderr, mesg, args);
+  fprintf (stderr, "\n");
+  va_end (args);
+}
+
+void
+rt_warn (const char *mesg, ...)
+{
+  va_list args;
+
+  va_start (args, mesg);
+  fprintf (stderr, "Runtime warning: ");
+  vfprintf (stderr, mesg, args);
+  fprintf (stderr, "\n");
+  va_end (args);
+}
+
+
+/* The operations. */
+
+static void op_add (void)       { bc_add (x, y, &result, 0); }
+static void op_add_mixed (void) { bc_add (x, yf, &result, 0); }
+static void op_sub (void)       { bc_sub (xf, yf, &result, 0); }
+static void op_sub_mixed (void) { bc_sub (xf, y, &result, 0); }
+static void op_multiply (void)  { bc_multiply (x, y, &result, 0); }
+static void op_divide (void)    { bc_divide (wide, x, &result, 0); }
+static void op_compare (void)   { bc_compare (x, y); }
+static void op_str2num (void)   { bc_str2num (&result, x_text, 0); }
+static void op_num2str (void)   { free (bc_num2str (x)); }
+
+static void
+op_add_frac (void)
+{
+  bc_add (xf, yf, &result, 0);
+}
+
+static void
+op_divmod (void)
+{
+  bc_num rem = NULL;
+
+  bc_divmod (wide, x, &result, &rem, 0);
+  bc_free_num (&rem);
+}
+
+/* XF to the eighth power, keeping the scale of XF. */
+
+static void
+op_raise (void)
+{
+  bc_num eight = NULL;
+
+  bc_int2num (&eight, 8);
+  bc_raise (xf, eight, &result, xf->n_scale);
+  bc_free_num (&eight);
+}
+
+static void
+op_raisemod (void)
+{
+  bc_raisemod (x, y, wide, &result, 0);
+}
+
+/* The square root of X to as many digits as X has. */
+
+static void
+op_sqrt (void)
+{
+  bc_free_num (&result);
+  result = bc_copy_num (x);
+  bc_sqrt (&result, (digits + 1) / 2);
+}
+
+static void
+count_char (int ch)
+{
+  out_count++;
+}
+
+static void op_out2 (void)   { bc_out_num (xf, 2, count_char, FALSE); }
+static void op_out10 (void)  { bc_out_num (xf, 10, count_char, FALSE); }
+static void op_out16 (void)  { bc_out_num (xf, 16, count_char, FALSE); }
+static void op_out100 (void) { bc_out_num (xf, 100, count_char, FALSE); }
+
+static struct {
+      const char *name;
+      void (*func) (void);
+      int done;			/* Past the limit. */
+    } ops[] = {
+  {"add",         op_add},
+  {"add_frac",    op_add_frac},
+  {"add_mixed",   op_add_mixed},
+  {"sub",         op_sub},
+  {"sub_mixed",   op_sub_mixed},
+  {"multiply",    op_multiply},
+  {"divide",      op_divide},
+  {"divmod",      op_divmod},
+  {"raise",       op_raise},
+  {"raisemod",    op_raisemod},
+  {"sqrt",        op_sqrt},
+  {"compare",     op_compare},
+  {"str2num",     op_str2num},
+  {"num2str",     op_num2str},
+  {"out2",        op_out2},
+  {"out10",       op_out10},
+  {"out16",       op_out16},
+  {"out100",      op_out100},
+};
+#define OP_COUNT (sizeof (ops) / sizeof (ops[0]))
+
+
+/* The seconds since some fixed time. */
+
+static double
+now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* A number of LEN digits from the seed, SCALE of them after the
+   decimal point.  The text is left in TEXT if it is not NULL. */
+
+static unsigned long seed = 1;
+
+static bc_num
+make_num (long len, int scale, int last, char **text)
+{
+  char *str;
+  long ix, pos;
+  bc_num num = NULL;
+
+  str = bc_num_malloc (len + 2);
+  for (ix = pos = 0; ix < len; ix++)
+    {
+      if (ix == len - scale && scale > 0)
+	str[pos++] = '.';
+      seed = seed * 1103515245 + 12345;
+      str[pos++] = '0' + (seed >> 16) % 10;
+    }
+  if (str[0] == '0')
+    str[0] = '1';
+  str[pos - 1] = '0' + last;
+  str[pos] = 0;
+  bc_str2num (&num, str, scale);
+  if (text != NULL)
+    *text = str;
+  else
+    free (str);
+  return num;
+}
+
+/* Set up the operands for LEN digits.  Starting from the same seed
+   gives X, Y, XF and YF the same digits. */
+
+static void
+make_operands (long len)
+{
+  digits = len;
+  seed = 1;
+  x = make_num (len, 0, 7, &x_text);
+  seed = 1;
+  y = make_num (len, 0, 3, NULL);
+  seed = 1;
+  xf = make_num (len, len / 2, 7, NULL);
+  seed = 1;
+  yf = make_num (len, len / 2, 3, NULL);
+  wide = make_num (2 * len, 0, 9, NULL);
+}
+
+static void
+free_operands (void)
+{
+  bc_free_num (&x);
+  bc_free_num (&y);
+  bc_free_num (&xf);
+  bc_free_num (&yf);
+  bc_free_num (&wide);
+  bc_free_num (&result);
+  free (x_text);
+}
+
+/* Time operation OP at the current size and print its line.  Each
+   round must take MIN_TIME seconds.  The operation is marked done if
+   one takes more than LIMIT seconds. */
+
+static void
+time_op (int op, double min_time, double limit)
+{
+  unsigned long reps, ix;
+  double start, time;
+
+  for (reps = 1; ; reps *= 2)
+    {
+      alloc_count = alloc_bytes = 0;
+      start = now ();
+      for (ix = 0; ix < reps; ix++)
+	ops[op].func ();
+      time = now () - start;
+      if (time >= min_time || (reps == 1 && time > limit))
+	break;
+    }
+  if (time / reps > limit)
+    ops[op].done = TRUE;
+
+  printf ("%s,%ld,%.1f,%.2f,%.1f,%lu\n", ops[op].name, digits,
+	  time / reps * 1e9, (double) alloc_count / reps,
+	  (double) alloc_bytes / reps, reps);
+  fflush (stdout);
+}
+
+static void
+usage (const char *progname)
+{
+  unsigned int op;
+
+  fprintf (stderr,
+	   "usage: %s [-m max-digits] [-t seconds] [-l seconds] [op ...]\n"
+	   "  -m  the largest operands, in digits (10000000)\n"
+	   "  -t  the least time for each line (0.2)\n"
+	   "  -l  stop an operation once one takes this long (2)\n"
+	   "The operations are", progname);
+  for (op = 0; op < OP_COUNT; op++)
+    fprintf (stderr, " %s", ops[op].name);
+  fprintf (stderr, ".\n");
+  exit (1);
+}
+
+int
+main (int argc, char **argv)
+{
+  long max_digits = 10000000, len;
+  double min_time = 0.2, limit = 2;
+  unsigned int op;
+  int opt, arg, found, step;
+
+  while ((opt = getopt (argc, argv, "m:t:l:")) != -1)
+    switch (opt)
+      {
+      case 'm':
+	max_digits = atol (optarg);
+	break;
+      case 't':
+	min_time = atof (optarg);
+	break;
+      case 'l':
+	limit = atof (optarg);
+	break;
+      default:
+	usage (argv[0]);
+      }
+  if (max_digits < 1 || min_time < 0 || limit <= 0)
+    usage (argv[0]);
+
+  /* The operations not named are done already. */
+  if (optind < argc)
+    {
+      for (op = 0; op < OP_COUNT; op++)
+	ops[op].done = TRUE;
+      for (arg = optind; arg < argc; arg++)
+	{
+	  found = FALSE;
+	  for (op = 0; op < OP_COUNT; op++)
+	    if (strcmp (argv[arg], ops[op].name) == 0)
+	      {
+		ops[op].done = FALSE;
+		found = TRUE;
+	      }
+	  if (!found)
+	    usage (argv[0]);
+	}
+    }
+
+  bc_init_numbers ();
+  printf ("op,digits,ns_per_op,allocs_per_op,bytes_per_op,reps\n");
+  for (len = 1, step = 0; len <= max_digits; )
+    {
+      make_operands (len);
+      for (op = 0; op < OP_COUNT; op++)
+	if (!ops[op].done)
+	  time_op (op, min_time, limit);
+      free_operands ();
+
+      /* 1, 2, 5, 10, 20, 50, ... */
+      len = (++step % 3 == 2 ? len / 2 * 5 : len * 2);
+      for (op = 0; op < OP_COUNT && ops[op].done; op++)
+	;
+      if (op == OP_COUNT)
+	break;
+    }
+  return 0;
+}
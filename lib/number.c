@@ -56,6 +56,8 @@
 #include <string.h>
 #endif
 #include <ctype.h>
+#include <limits.h>
+#include <math.h>
 
 /* Prototypes needed for external utility routines. */
 
@@ -75,6 +77,62 @@ bc_num _two_;
 
 static bc_num _bc_Free_list = NULL;
 
+#ifdef BC_STATS
+unsigned long bc_stats_new = 0, bc_stats_reused = 0;
+#endif
+
+/* The bytes of number storage in use and the most there have been.
+   GMP gives the size of each block it frees, so the count is exact.
+   GMP allocates from the threads of bsplit.c and map.c too, so the
+   counts are changed atomically.  When bc_mem_limit is not 0 and the
+   bytes in use pass it, bc_mem_exceeded is set for the program to
+   stop what it is running.  The memory is still given, as GMP has no
+   way to be refused. */
+size_t bc_mem_bytes = 0;
+size_t bc_mem_peak = 0;
+size_t bc_mem_limit = 0;
+volatile int bc_mem_exceeded = FALSE;
+
+/* Set to stop the long operations between their steps. */
+volatile int bc_cancel = FALSE;
+
+static void
+mem_more (size_t size)
+{
+  size_t now, peak;
+
+  now = __sync_add_and_fetch (&bc_mem_bytes, size);
+  while ((peak = bc_mem_peak) < now
+	 && !__sync_bool_compare_and_swap (&bc_mem_peak, peak, now))
+    ;
+  if (bc_mem_limit != 0 && now > bc_mem_limit)
+    bc_mem_exceeded = bc_cancel = TRUE;
+}
+
+static void *
+mem_malloc (size_t size)
+{
+  mem_more (size);
+  return bc_num_malloc (size);
+}
+
+static void *
+mem_realloc (void *ptr, size_t oldsize, size_t newsize)
+{
+  if (newsize > oldsize)
+    mem_more (newsize - oldsize);
+  else
+    __sync_sub_and_fetch (&bc_mem_bytes, oldsize - newsize);
+  return bc_num_realloc (ptr, oldsize, newsize);
+}
+
+static void
+mem_free (void *ptr, size_t size)
+{
+  __sync_sub_and_fetch (&bc_mem_bytes, size);
+  free (ptr);
+}
+
 /* new_num allocates a number and sets fields to known values. */
 
 bc_num
@@ -82,11 +140,15 @@ bc_new_num (int length, int scale)
 {
   bc_num temp;
 
+#ifdef BC_STATS
+  bc_stats_new++;
+  if (_bc_Free_list != NULL) bc_stats_reused++;
+#endif
   if (_bc_Free_list != NULL) {
     temp = _bc_Free_list;
     _bc_Free_list = temp->n_next;
   } else {
-    temp = (bc_num) bc_num_malloc (sizeof(bc_struct));
+    temp = (bc_num) mem_malloc (sizeof(bc_struct));
   }
   length = 0; /* To silence the compiler without changing the API. */
   temp->n_scale = scale;
@@ -118,7 +180,7 @@ void
 bc_init_numbers (void)
 {
   /* Initialize gmp to use our routines. */
-  mp_set_memory_functions(&bc_num_malloc, &bc_num_realloc, NULL);
+  mp_set_memory_functions(&mem_malloc, &mem_realloc, &mem_free);
 
   _zero_ = bc_new_num (1,0);
   _one_  = bc_new_num (1,0);
@@ -431,6 +493,57 @@ bc_divide (bc_num n1, bc_num n2, bc_num *quot,  int scale)
 }
 
 
+/* Division by a small integer.  This computes N1 / DIVISOR with SCALE
+   digits after the decimal point, truncating just as bc_divide does.
+   Because truncation nests, dividing by A and then by B gives the
+   same answer as one division by A*B.  It returns -1 if division by
+   zero is tried. */
+
+int
+bc_divide_ui (bc_num n1, unsigned long divisor, bc_num *quot, int scale)
+{
+  bc_num qval;
+  mpz_t step;
+  int step_amt;
+
+  /* Test for divide by zero. */
+  if (divisor == 0) return -1;
+
+  /* Do the divide. */
+  qval = bc_new_num (1, scale);
+
+  /* Step the dividend to have scale after the divide. */
+  step_amt = scale - n1->n_scale;
+
+  if (step_amt != 0)
+    {
+      mpz_init_set_si (step, 10);
+
+      if (step_amt > 0)
+	{
+	  mpz_pow_ui (step, step, step_amt);
+	  mpz_mul (qval->n_value, n1->n_value, step);
+	}
+      else
+	{
+	  mpz_pow_ui (step, step, -step_amt);
+	  mpz_tdiv_q (qval->n_value, n1->n_value, step);
+	}
+
+      mpz_tdiv_q_ui (qval->n_value, qval->n_value, divisor);
+
+      mpz_clear (step);
+    }
+  else
+    mpz_tdiv_q_ui (qval->n_value, n1->n_value, divisor);
+
+  bc_free_num (quot);
+  *quot = qval;
+
+  return 0;	/* Everything is OK. */
+}
+
+
 /* Division *and* modulo for numbers.  This computes both NUM1 / NUM2 and
    NUM1 % NUM2  and puts the results in QUOT and REM, except that if QUOT
    is NULL then that store will be omitted.
@@ -514,7 +627,7 @@ bc_raisemod (bc_num base, bc_num expo, bc_num mod, bc_num *result, int scale)
 
   /* Do the calculation. */
   rscale = MAX(scale, base->n_scale);
-  while ( !bc_is_zero(exponent) )
+  while ( !bc_is_zero(exponent) && !bc_cancel )
     {
       (void) bc_divmod (exponent, _two_, &exponent, &parity, 0);
       if ( !bc_is_zero(parity) )
@@ -535,6 +648,9 @@ bc_raisemod (bc_num base, bc_num expo, bc_num mod, bc_num *result, int scale)
   return 0;	/* Everything is OK. */
 }
 
+/* The bits of a power above which bc_raise does the steps itself. */
+#define RAISE_STEPPED 1000000.0
+
 /* Raise NUM1 to the NUM2 power.  The result is placed in RESULT.
    Maximum exponent is LONG_MAX.  If a NUM2 is not an integer,
    only the integer part is used.  */
@@ -577,12 +693,54 @@ bc_raise (bc_num num1, bc_num num2, bc_num *result, int scale)
       rscale = MIN (num1->n_scale*exponent, MAX(scale, num1->n_scale));
     }
 
+  /* A power that would pass the memory limit is not tried.  Its
+     size in bits is EXPONENT times the log of the base, and GMP works
+     in about as much again. */
+  if (bc_mem_limit != 0 && !bc_is_zero (num1))
+    {
+      long bits;
+      double fraction = mpz_get_d_2exp (&bits, num1->n_value);
+      double size = (bits + log2 (fabs (fraction))) * exponent / 4;
+
+      if (size > (double) (bc_mem_limit - MIN (bc_mem_limit, bc_mem_bytes)))
+	{
+	  bc_mem_exceeded = TRUE;
+	  bc_free_num (result);
+	  *result = bc_copy_num (_zero_);
+	  return;
+	}
+    }
+
   temp = bc_new_num(1, rscale);
 
   diffscale = num1->n_scale*exponent - rscale;
 
-  /* Compute the power.  */
-  mpz_pow_ui(temp->n_value, num1->n_value, exponent);
+  /* Compute the power.  A large one is done a square or a multiply at
+     a time, high bit of the exponent first, so that bc_cancel is seen
+     between the steps.  A cancelled power is zero. */
+  if (mpz_sizeinbase (num1->n_value, 2) * (double) exponent < RAISE_STEPPED)
+    mpz_pow_ui(temp->n_value, num1->n_value, exponent);
+  else
+    {
+      int bit;
+
+      for (bit = 0; (exponent >> bit) > 1; bit++)
+	;
+      mpz_set (temp->n_value, num1->n_value);
+      while (--bit >= 0 && !bc_cancel)
+	{
+	  mpz_mul (temp->n_value, temp->n_value, temp->n_value);
+	  if ((exponent >> bit) & 1)
+	    mpz_mul (temp->n_value, temp->n_value, num1->n_value);
+	}
+      if (bc_cancel)
+	{
+	  bc_free_num (&temp);
+	  bc_free_num (result);
+	  *result = bc_copy_num (_zero_);
+	  return;
+	}
+    }
 
   /* Step it correctly. */
   if (diffscale != 0)
@@ -677,6 +835,451 @@ bc_sqrt (bc_num *num, int scale)
 }
 
 
+/* Initialize VAL to the integer part of NUM. */
+
+static void
+_bc_int_part (bc_num num, mpz_t val)
+{
+  mpz_t step;
+
+  mpz_init_set (val, num->n_value);
+  if (num->n_scale > 0)
+    {
+      mpz_init (step);
+      mpz_ui_pow_ui (step, 10, num->n_scale);
+      mpz_tdiv_q (val, val, step);
+      mpz_clear (step);
+    }
+}
+
+/* Make a new integer bc_num from VAL, clear VAL and place the number
+   in RESULT. */
+
+static void
+_bc_int_result (mpz_t val, bc_num *result)
+{
+  bc_num temp;
+
+  temp = bc_new_num (1, 0);
+  mpz_swap (temp->n_value, val);
+  mpz_clear (val);
+  bc_free_num (result);
+  *result = temp;
+}
+
+
+/* Compute N! and place it in RESULT.  GMP builds the product with a
+   balanced tree, so this is much faster than a loop of multiplies. */
+
+void
+bc_factorial (unsigned long n, bc_num *result)
+{
+  bc_num fact;
+
+  fact = bc_new_num (1, 0);
+  mpz_fac_ui (fact->n_value, n);
+
+  bc_free_num (result);
+  *result = fact;
+}
+
+/* Place the binomial coefficient C(N,K) in RESULT.  Only the integer
+   part of N is used and it may be negative. */
+
+void
+bc_binomial (bc_num n, unsigned long k, bc_num *result)
+{
+  mpz_t val;
+
+  _bc_int_part (n, val);
+  mpz_bin_ui (val, val, k);
+  _bc_int_result (val, result);
+}
+
+/* Place the Nth Fibonacci number in RESULT. */
+
+void
+bc_fibonacci (unsigned long n, bc_num *result)
+{
+  bc_num fib;
+
+  fib = bc_new_num (1, 0);
+  mpz_fib_ui (fib->n_value, n);
+
+  bc_free_num (result);
+  *result = fib;
+}
+
+/* Place the Nth Lucas number in RESULT. */
+
+void
+bc_lucas (unsigned long n, bc_num *result)
+{
+  bc_num luc;
+
+  luc = bc_new_num (1, 0);
+  mpz_lucnum_ui (luc->n_value, n);
+
+  bc_free_num (result);
+  *result = luc;
+}
+
+
+/* Number theory.  These routines use the integer part of their
+   arguments and give integers. */
+
+/* Is NUM prime?  Returns 2 if it is surely prime, 1 if it is
+   probably prime (the chance of error is less than 4^-REPS) and 0 if
+   it is not prime.  Numbers less than 2 are not prime; GMP would
+   test the absolute value. */
+
+int
+bc_isprime (bc_num num, int reps)
+{
+  mpz_t val;
+  int res;
+
+  _bc_int_part (num, val);
+  res = (mpz_cmp_ui (val, 2) < 0 ? 0 : mpz_probab_prime_p (val, reps));
+  mpz_clear (val);
+  return res;
+}
+
+/* Place the first (probable) prime greater than NUM in RESULT. */
+
+void
+bc_nextprime (bc_num num, bc_num *result)
+{
+  mpz_t val;
+
+  _bc_int_part (num, val);
+  mpz_nextprime (val, val);
+  _bc_int_result (val, result);
+}
+
+/* Place the greatest common divisor of N1 and N2 in RESULT. */
+
+void
+bc_gcd (bc_num n1, bc_num n2, bc_num *result)
+{
+  mpz_t v1, v2;
+
+  _bc_int_part (n1, v1);
+  _bc_int_part (n2, v2);
+  mpz_gcd (v1, v1, v2);
+  mpz_clear (v2);
+  _bc_int_result (v1, result);
+}
+
+/* Place the least common multiple of N1 and N2 in RESULT. */
+
+void
+bc_lcm (bc_num n1, bc_num n2, bc_num *result)
+{
+  mpz_t v1, v2;
+
+  _bc_int_part (n1, v1);
+  _bc_int_part (n2, v2);
+  mpz_lcm (v1, v1, v2);
+  mpz_clear (v2);
+  _bc_int_result (v1, result);
+}
+
+/* Place the inverse of NUM modulo MOD, from 0 to |MOD|-1, in RESULT.
+   Returns -1 if there is no inverse. */
+
+int
+bc_modinv (bc_num num, bc_num mod, bc_num *result)
+{
+  mpz_t val, modval;
+  int ok;
+
+  _bc_int_part (num, val);
+  _bc_int_part (mod, modval);
+  ok = mpz_sgn (modval) != 0 && mpz_invert (val, val, modval);
+  mpz_clear (modval);
+  if (!ok)
+    {
+      mpz_clear (val);
+      return -1;
+    }
+  _bc_int_result (val, result);
+  return 0;
+}
+
+/* The Jacobi symbol (N1/N2), which is -1, 0 or 1.  N2 must be odd and
+   positive; if it is not, -2 is returned. */
+
+int
+bc_jacobi (bc_num n1, bc_num n2)
+{
+  mpz_t v1, v2;
+  int res;
+
+  _bc_int_part (n1, v1);
+  _bc_int_part (n2, v2);
+  if (mpz_sgn (v2) <= 0 || mpz_even_p (v2))
+    res = -2;
+  else
+    res = mpz_jacobi (v1, v2);
+  mpz_clear (v1);
+  mpz_clear (v2);
+  return res;
+}
+
+
+/* Bit operations.  These work on integers only, in two's complement
+   with an infinite sign extension as GMP does.  Those that return
+   an int give -1 if an argument has a fraction part. */
+
+/* Initialize VAL to the value of NUM.  Returns FALSE, leaving VAL
+   cleared, if NUM is not an integer. */
+
+static int
+_bc_int_value (bc_num num, mpz_t val)
+{
+  mpz_t step;
+  int whole;
+
+  mpz_init_set (val, num->n_value);
+  if (num->n_scale == 0)
+    return TRUE;
+
+  mpz_init (step);
+  mpz_ui_pow_ui (step, 10, num->n_scale);
+  whole = mpz_divisible_p (val, step);
+  if (whole)
+    mpz_divexact (val, val, step);
+  else
+    mpz_clear (val);
+  mpz_clear (step);
+  return whole;
+}
+
+/* Place N1 OP N2 in RESULT, where OP is one of '&', '|' and '^', or
+   the complement of N1 if OP is '~'. */
+
+int
+bc_logic (int op, bc_num n1, bc_num n2, bc_num *result)
+{
+  mpz_t v1, v2;
+
+  if (!_bc_int_value (n1, v1))
+    return -1;
+  if (op == '~')
+    mpz_com (v1, v1);
+  else
+    {
+      if (!_bc_int_value (n2, v2))
+	{
+	  mpz_clear (v1);
+	  return -1;
+	}
+      switch (op)
+	{
+	case '&':
+	  mpz_and (v1, v1, v2);
+	  break;
+	case '|':
+	  mpz_ior (v1, v1, v2);
+	  break;
+	default:
+	  mpz_xor (v1, v1, v2);
+	  break;
+	}
+      mpz_clear (v2);
+    }
+  _bc_int_result (v1, result);
+  return 0;
+}
+
+/* Place NUM*2^BITS in RESULT.  A negative BITS shifts right, rounding
+   towards minus infinity. */
+
+int
+bc_shift (bc_num num, long bits, bc_num *result)
+{
+  mpz_t val;
+
+  if (!_bc_int_value (num, val))
+    return -1;
+  if (bits >= 0)
+    mpz_mul_2exp (val, val, bits);
+  else
+    mpz_fdiv_q_2exp (val, val, -bits);
+  _bc_int_result (val, result);
+  return 0;
+}
+
+/* The number of one bits in NUM, or -2 if NUM is negative and so has
+   infinitely many. */
+
+long
+bc_popcount (bc_num num)
+{
+  mpz_t val;
+  long count;
+
+  if (!_bc_int_value (num, val))
+    return -1;
+  if (mpz_sgn (val) < 0)
+    count = -2;
+  else
+    count = mpz_popcount (val);
+  mpz_clear (val);
+  return count;
+}
+
+/* The number of bits in the magnitude of NUM, 0 for zero. */
+
+long
+bc_bitlen (bc_num num)
+{
+  mpz_t val;
+  long len;
+
+  if (!_bc_int_value (num, val))
+    return -1;
+  len = (mpz_sgn (val) == 0 ? 0 : mpz_sizeinbase (val, 2));
+  mpz_clear (val);
+  return len;
+}
+
+/* Place the integer part of the Nth root of NUM in RESULT.  Returns -2
+   for an even root of a negative number. */
+
+int
+bc_iroot (bc_num num, unsigned long n, bc_num *result)
+{
+  mpz_t val;
+
+  if (!_bc_int_value (num, val))
+    return -1;
+  if (mpz_sgn (val) < 0 && n % 2 == 0)
+    {
+      mpz_clear (val);
+      return -2;
+    }
+  mpz_root (val, val, n);
+  _bc_int_result (val, result);
+  return 0;
+}
+
+
+/* Random numbers from the GMP generator.  The state is set up on
+   first use and bc_srandom restarts the sequence. */
+
+static gmp_randstate_t _bc_randstate;
+static int _bc_rand_ready = FALSE;
+
+/* Seed the generator with the integer part of SEED. */
+
+void
+bc_srandom (bc_num seed)
+{
+  mpz_t val;
+
+  if (!_bc_rand_ready)
+    {
+      gmp_randinit_default (_bc_randstate);
+      _bc_rand_ready = TRUE;
+    }
+  _bc_int_part (seed, val);
+  mpz_abs (val, val);
+  gmp_randseed (_bc_randstate, val);
+  mpz_clear (val);
+}
+
+/* Place a uniform random number in RESULT.  If BOUND is NULL the
+   number is in [0,1) with SCALE digits, otherwise it is an integer
+   from 0 to BOUND-1.  Returns -1 if the integer part of BOUND is not
+   positive. */
+
+int
+bc_random (bc_num bound, int scale, bc_num *result)
+{
+  bc_num temp;
+  mpz_t limit;
+
+  if (bound != NULL)
+    _bc_int_part (bound, limit);
+  else
+    {
+      mpz_init (limit);
+      mpz_ui_pow_ui (limit, 10, scale);
+    }
+  if (mpz_sgn (limit) <= 0)
+    {
+      mpz_clear (limit);
+      return -1;
+    }
+  if (!_bc_rand_ready)
+    {
+      gmp_randinit_default (_bc_randstate);
+      _bc_rand_ready = TRUE;
+    }
+
+  temp = bc_new_num (1, bound != NULL ? 0 : scale);
+  mpz_urandomm (temp->n_value, _bc_randstate, limit);
+  mpz_clear (limit);
+  bc_free_num (result);
+  *result = temp;
+  return 0;
+}
+
+
+/* Mathematical constants.  Each is computed once at the highest scale
+   asked for so far and kept.  A request for a lower scale is the kept
+   value truncated, so a constant is only computed again when a higher
+   scale is first asked for. */
+
+/* Extra digits carried while computing a constant. */
+#define CONST_GUARD 12
+
+static bc_num _bc_constants[BC_NUM_CONSTANTS];
+
+/* Place constant WHICH (BC_PI, BC_LN2, BC_LN10 or BC_E) with SCALE
+   digits after the decimal point in RESULT.  Returns -1 if WHICH is
+   not a known constant and -2 if bc_cancel stopped the computation,
+   when RESULT is not changed and nothing is kept. */
+
+int
+bc_constant (int which, int scale, bc_num *result)
+{
+  bc_num value;
+  mpz_t step;
+
+  if (which < 0 || which >= BC_NUM_CONSTANTS) return -1;
+
+  value = _bc_constants[which];
+  if (value == NULL || value->n_scale < scale)
+    {
+      value = bc_new_num (1, scale);
+      bc_bsplit_constant (which, scale + CONST_GUARD, value->n_value);
+      if (bc_cancel)
+	{
+	  bc_free_num (&value);
+	  return -2;
+	}
+      mpz_init (step);
+      mpz_ui_pow_ui (step, 10, CONST_GUARD);
+      mpz_tdiv_q (value->n_value, value->n_value, step);
+      mpz_clear (step);
+      bc_free_num (&_bc_constants[which]);
+      _bc_constants[which] = value;
+    }
+
+  if (value->n_scale == scale)
+    {
+      bc_free_num (result);
+      *result = bc_copy_num (value);
+    }
+  else
+    bc_divide (value, _one_, result, scale);
+  return 0;
+}
+
+
 /* The following routines provide output for bcd numbers package
    using the rules of POSIX bc for output. */
 
@@ -734,12 +1337,17 @@ bc_out_num (bc_num num, int o_base, void (*out_char)(int), int leading_zero)
     if (o_base == 10)
       {
 	/* The number is in base 10, do it the fast way. */
-	nptr = bc_num2str(num);
+	char buf[BC_DEC_BUF];
+
+	nptr = buf;
+	if (bc_num2dec (num, buf, sizeof (buf)) < 0)
+	  nptr = bc_num2str (num);
 	iptr = nptr;
 	if (*iptr == '-') iptr++;
 	while (*iptr) (*out_char) (*iptr++);
 
-	free (nptr);
+	if (nptr != buf)
+	  free (nptr);
       }
     else
       {
@@ -771,7 +1379,7 @@ bc_out_num (bc_num num, int o_base, void (*out_char)(int), int leading_zero)
 	free (nptr);
 
 	/* Get the digits of the integer part and push them on a stack. */
-	while (!bc_is_zero (int_part))
+	while (!bc_is_zero (int_part) && !bc_cancel)
 	  {
 	    bc_modulo (int_part, base, &cur_dig, 0);
 	    temp = (stk_rec *) bc_num_malloc (sizeof(stk_rec));
@@ -789,7 +1397,9 @@ bc_out_num (bc_num num, int o_base, void (*out_char)(int), int leading_zero)
 	      {
 		temp = digits;
 		digits = digits->next;
-		if (o_base <= 16)
+		if (bc_cancel)
+		  ;	/* Only some of the digits are known. */
+		else if (o_base <= 16)
 		  (*out_char) (ref_str[ (int) temp->digit]);
 		else
 		  bc_out_long (temp->digit, ix, 1, out_char);
@@ -804,7 +1414,7 @@ bc_out_num (bc_num num, int o_base, void (*out_char)(int), int leading_zero)
 	    pre_space = 0;
 	    t_num = bc_copy_num (_one_);
 	    t_len = bc_num_length (t_num);
-	    while (t_len <= num->n_scale)
+	    while (t_len <= num->n_scale && !bc_cancel)
 	      {
 		bc_multiply (frac_part, base, &frac_part, num->n_scale);
 		fdigit = bc_num2long (frac_part);
@@ -890,67 +1500,214 @@ bc_int2num (bc_num *num, int val)
   mpz_set_si ((*num)->n_value, val);
 }
 
-/* Convert a number to a string.  Base 10 only.*/
+/* Decimal output.  bc_num2dec writes the digits straight into the
+   caller's buffer and places the point and the leading zeros of the
+   fraction there.  A value that fits an unsigned long is converted
+   two digits at a time from a table; a longer one by mpz_get_str. */
 
-char
-*bc_num2str (bc_num num)
+static const char _bc_digit_pairs[] =
+  "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+  "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+/* The size of the buffer bc_num2dec needs for NUM. */
+
+int
+bc_num2dec_size (bc_num num)
 {
-  char *str, *sptr;
-  char *nptr, *iptr;
-  int  i, signch, s_len, n_len;
+  int s_len = mpz_sizeinbase (num->n_value, 10);
 
-  /* Allocate the string memory. */
-  signch = ( bc_is_neg(num) ? 1 : 0 );  /* Number of sign chars. */
-  s_len = mpz_sizeinbase (num->n_value, 10); /* Number of digits. */
-  if (num->n_scale > 0)
-    str = (char *) malloc (s_len + num->n_scale + 2 + signch);
-  else
-    str = (char *) malloc (s_len + 1 + signch);
+  return (bc_is_neg (num) ? 1 : 0) + MAX (s_len, num->n_scale) + 2;
+}
 
-  /* Convert the string to decimal. */
-  n_len = gmp_asprintf(&nptr, "%Zd", num->n_value);
+/* Write NUM in base 10 to STR, which has room for SIZE characters.
+   Returns the length written, without the NUL terminator, or -1 if
+   it would not fit. */
+
+int
+bc_num2dec (bc_num num, char *str, int size)
+{
+  char digits[3 * sizeof (unsigned long)], *dptr, *sptr;
+  unsigned long val;
+  int n_len, scale, i;
+
+  if (size < bc_num2dec_size (num))
+    return -1;
 
-  /* The negative sign if needed. */
   sptr = str;
-  iptr = nptr;
-  if (signch)
-    {
-      *sptr++ = '-';
-      iptr++;
-      n_len--;
-    }
+  if (bc_is_neg (num))
+    *sptr++ = '-';
 
-  if (n_len >= num->n_scale)
+  /* The digits of the value, at SPTR. */
+  if (mpz_sizeinbase (num->n_value, 2) <= CHAR_BIT * sizeof (unsigned long))
     {
-      /* Load the whole number. */
-      for (i = n_len - num->n_scale; i > 0; i--)
-	*sptr++ = *iptr++;
-
-      /* Now the fraction. */
-      if (num->n_scale > 0)
+      val = mpz_get_ui (num->n_value);
+      dptr = digits + sizeof (digits);
+      while (val >= 100)
 	{
-	  *sptr++ = '.';
-	  for (i=0; i<num->n_scale; i++)
-	    *sptr++ = *iptr++;
+	  i = (val % 100) * 2;
+	  val /= 100;
+	  *--dptr = _bc_digit_pairs[i+1];
+	  *--dptr = _bc_digit_pairs[i];
 	}
+      if (val >= 10)
+	{
+	  *--dptr = _bc_digit_pairs[val*2+1];
+	  *--dptr = _bc_digit_pairs[val*2];
+	}
+      else
+	*--dptr = '0' + val;
+      n_len = digits + sizeof (digits) - dptr;
+      memcpy (sptr, dptr, n_len);
     }
   else
     {
-      /* The number is less than 1. */
-      *sptr++ = '.';
-      for (i = 0; i < num->n_scale - n_len; i++)
-	*sptr++ = '0';
-      for (i=0; i<n_len; i++)
-	*sptr++ = *iptr++;
+      /* mpz_get_str writes the sign again. */
+      mpz_get_str (str, 10, num->n_value);
+      n_len = strlen (sptr);
     }
 
-  /* Free memory. */
-  free (nptr);
+  /* Place the point. */
+  scale = num->n_scale;
+  if (scale > 0)
+    {
+      if (n_len >= scale)
+	{
+	  memmove (sptr + n_len - scale + 1, sptr + n_len - scale, scale);
+	  sptr[n_len - scale] = '.';
+	}
+      else
+	{
+	  /* The number is less than 1. */
+	  memmove (sptr + 1 + scale - n_len, sptr, n_len);
+	  sptr[0] = '.';
+	  memset (sptr + 1, '0', scale - n_len);
+	  n_len = scale;
+	}
+      n_len++;
+    }
+  sptr[n_len] = '\0';
+  return sptr + n_len - str;
+}
 
-  /* Terminate the string and return it! */
-  *sptr = '\0';
+/* Convert a number to a string.  Base 10 only.*/
+
+char
+*bc_num2str (bc_num num)
+{
+  char *str;
+  int size;
+
+  size = bc_num2dec_size (num);
+  str = (char *) bc_num_malloc (size);
+  bc_num2dec (num, str, size);
   return (str);
 }
+
+/* Decimal input.  Most numbers are short, so bc_set_decimal converts
+   them in registers: eight ASCII digits at a time as one 64 bit word
+   (SWAR), then groups of digits that fit an unsigned long, which are
+   put in the mpz_t with one multiply and add.  That is linear in the
+   number of groups, so longer input goes to mpz_set_str, which is
+   subquadratic.  The word trick needs the first digit in the low
+   byte, so on other machines the digits are taken one at a time. */
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BC_SWAR 1
+#endif
+
+/* The digits in a group, and the longest input done by groups. */
+#define BC_GROUP_DIGITS (ULONG_MAX > 0xffffffffUL ? 19 : 9)
+#define BC_GROUP_MAX (3 * BC_GROUP_DIGITS)
+
+#ifdef BC_SWAR
+/* Convert the eight digits at STR into *VALUE.  Returns FALSE if they
+   are not all digits. */
+
+static int
+_bc_eight_digits (const char *str, unsigned long long *value)
+{
+  unsigned long long chunk;
+
+  memcpy (&chunk, str, 8);
+  if (((chunk & 0xF0F0F0F0F0F0F0F0ULL)
+       | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+      != 0x3333333333333333ULL)
+    return FALSE;
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+  chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+  chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFFULL;
+  *value = chunk;
+  return TRUE;
+}
+#endif
+
+/* Set VALUE to the LEN decimal digits at DIGITS.  Returns FALSE if
+   they are not all digits, and VALUE is then not set. */
+
+int
+bc_set_decimal (mpz_t value, char *digits, int len)
+{
+  unsigned long group, power;
+#ifdef BC_SWAR
+  unsigned long long chunk;
+#endif
+  char save;
+  int count, first, ix;
+
+  if (len > BC_GROUP_MAX)
+    {
+      for (ix = 0; ix < len; ix++)
+	if (!isdigit ((int) digits[ix]))
+	  return FALSE;
+      save = digits[len];
+      digits[len] = '\0';
+      mpz_set_str (value, digits, 10);
+      digits[len] = save;
+      return TRUE;
+    }
+
+  /* The first group takes what is left over, so that the others are
+     full. */
+  count = len % BC_GROUP_DIGITS;
+  if (count == 0)
+    count = BC_GROUP_DIGITS;
+  first = TRUE;
+  mpz_set_ui (value, 0);
+  while (len > 0)
+    {
+      len -= count;
+      group = 0;
+      power = 1;
+#ifdef BC_SWAR
+      for (; count >= 8; count -= 8, digits += 8)
+	{
+	  if (!_bc_eight_digits (digits, &chunk))
+	    return FALSE;
+	  group = group * 100000000UL + (unsigned long) chunk;
+	  power *= 100000000UL;
+	}
+#endif
+      for (; count > 0; count--, digits++)
+	{
+	  if ((unsigned) (*digits - '0') >= 10)
+	    return FALSE;
+	  group = group * 10 + (*digits - '0');
+	  power *= 10;
+	}
+      if (first)
+	mpz_set_ui (value, group);
+      else
+	{
+	  mpz_mul_ui (value, value, power);
+	  mpz_add_ui (value, value, group);
+	}
+      first = FALSE;
+      count = BC_GROUP_DIGITS;
+    }
+  return TRUE;
+}
+
 /* Convert a string to a bc number.  Base 10 only.*/
 
 void
@@ -998,11 +1755,104 @@ bc_str2num (bc_num *num, char *str, int scale)
   *iptr = '\0';				       /* NUL terminator */
 
   /* Read in. */
-  gmp_sscanf(nptr, "%Zd", (*num)->n_value);
+  if (*nptr == '-')
+    {
+      bc_set_decimal ((*num)->n_value, nptr+1, iptr - nptr - 1);
+      mpz_neg ((*num)->n_value, (*num)->n_value);
+    }
+  else
+    bc_set_decimal ((*num)->n_value, nptr, iptr - nptr);
 
   free (nptr);
 }
 
+/* The powers used for the fraction by bc_digits2num.  Constants in a
+   program tend to have the same length, so the last ones are kept. */
+
+static mpz_t _bc_frac_ten, _bc_frac_base;
+static int _bc_frac_len = -1, _bc_frac_radix = 0;
+
+/* Convert a string of digits in base BASE to a bc number.  DIGITS
+   holds INT_LEN digits before the point and then FRAC_LEN digits after
+   it, as the characters 0-9 and a-z, and is NUL terminated.  As in bc,
+   a lone digit before the point may be larger than the base and the
+   fraction is truncated to FRAC_LEN decimal digits.
+
+   mpz_set_str packs the bits directly for a power of two base and
+   otherwise converts by divide and conquer, so this is subquadratic. */
+
+void
+bc_digits2num (bc_num *num, char *digits, int int_len, int frac_len,
+	       int base, int negative)
+{
+  bc_num temp;
+  mpz_t frac;
+  char save;
+  int bits;
+
+  temp = bc_new_num (1, frac_len);
+
+  /* In base 10 the digits are the value at scale frac_len. */
+  if (base == 10 && (int_len != 1 || isdigit ((int) digits[0])))
+    {
+      bc_set_decimal (temp->n_value, digits, int_len + frac_len);
+      frac_len = 0;
+    }
+  else if (int_len == 1)
+    mpz_set_ui (temp->n_value, isdigit ((int) digits[0])
+		? digits[0] - '0' : digits[0] - 'a' + 10);
+  else if (int_len > 1)
+    {
+      save = digits[int_len];
+      digits[int_len] = '\0';
+      mpz_set_str (temp->n_value, digits, base);
+      digits[int_len] = save;
+    }
+
+  if (frac_len > 0)
+    {
+      /* The fraction is frac * 10^frac_len / base^frac_len. */
+      if (_bc_frac_len < 0)
+	{
+	  mpz_init (_bc_frac_ten);
+	  mpz_init (_bc_frac_base);
+	}
+      if (frac_len != _bc_frac_len)
+	{
+	  mpz_ui_pow_ui (_bc_frac_ten, 10, frac_len);
+	  _bc_frac_radix = 0;
+	}
+      _bc_frac_len = frac_len;
+
+      mpz_mul (temp->n_value, temp->n_value, _bc_frac_ten);
+      mpz_init_set_str (frac, digits + int_len, base);
+      if (base != 10)
+	{
+	  mpz_mul (frac, frac, _bc_frac_ten);
+	  for (bits = 0; (1 << bits) < base; bits++)
+	    ;
+	  if ((1 << bits) == base)
+	    mpz_tdiv_q_2exp (frac, frac, (unsigned long) bits * frac_len);
+	  else
+	    {
+	      if (base != _bc_frac_radix)
+		{
+		  mpz_ui_pow_ui (_bc_frac_base, base, frac_len);
+		  _bc_frac_radix = base;
+		}
+	      mpz_tdiv_q (frac, frac, _bc_frac_base);
+	    }
+	}
+      mpz_add (temp->n_value, temp->n_value, frac);
+      mpz_clear (frac);
+    }
+
+  if (negative)
+    mpz_neg (temp->n_value, temp->n_value);
+  bc_free_num (num);
+  *num = temp;
+}
+
 /* Give the number of significant digits in a bc_num. */
 
 int
@@ -1013,9 +1863,10 @@ bc_num_length (bc_num num)
 
   n_len = gmp_asprintf(&nptr, "%Zd", num->n_value);
 
-  if (*nptr == '-') n_len--;
+  /* GMP sized the string to fit. */
+  mem_free (nptr, n_len + 1);
 
-  free (nptr);
+  if (mpz_sgn (num->n_value) < 0) n_len--;
 
   return n_len;
 }